@@ -393,7 +393,7 @@ template<class X> class CAutoPtr : public CBasicAutoPtr<X>
 
 	X * operator->() const throw( CException )
 	{
-		X * ptr = GetPtrFromRef();
+		X * ptr = this->GetPtrFromRef();
 
 		if( ptr == 0 )
 		{
@@ -420,7 +420,7 @@ template<class X> class CAutoPtr : public CBasicAutoPtr<X>
 
 	inline CAutoPtr & operator=( X * p ) throw( CException )
 	{
-		Reset( p );
+		this->Reset( p );
 		return( *this );
 	}
 }; // CAutoPtr
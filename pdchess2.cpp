@@ -1,12 +1,42 @@
 // pdchess2 - Tom Weatherhead - June 8, 2002
 
 // To Do:
-// - Use the GeneratedMoveType and the > and >= operators.
+// - Use the > and >= operators.
 
 #include <iostream>
-#include <cstdlib>			// For srand(), rand().
+#include <sstream>			// For istringstream.
+#include <cstdlib>			// For atoi(), atof(), strtoull().
+#include <cstring>			// For memcpy(), memset(), memchr().
 #include <ctime>			// For time().
+#include <cmath>			// For pow(), log(), log10().
+#include <fstream>			// For ofstream.
 #include <vector>
+#include <map>
+#include <string>
+#include <chrono>			// For steady_clock.
+#include <algorithm>		// For rotate(), find(), sort().
+#include <atomic>
+#include <thread>
+#include <mutex>
+
+#if defined( _MSC_VER )
+#include <intrin.h>			// For _BitScanForward64(), __popcnt64().
+#endif
+
+#if defined( _WIN32 )
+#define NOMINMAX
+#include <windows.h>		// For CreateFileMapping(), MapViewOfFile().
+#else
+#include <fcntl.h>			// For open().
+#include <sys/mman.h>		// For mmap().
+#include <sys/stat.h>		// For fstat().
+#include <unistd.h>			// For close().
+#endif
+
+#if defined( __BMI2__ )
+#include <immintrin.h>		// For _pext_u64().
+#define PDCHESS_USE_PEXT	1
+#endif
 
 #include "auto-ptr.h"
 
@@ -19,11 +49,71 @@ static const int cnBoardSize = 8;
 static const int cnBoardArea = cnBoardSize * cnBoardSize;
 
 
+// **** Bitboards ****
+
+// A bitboard is a set of squares; bit n represents the square 8 * row + col.
+
+typedef unsigned long long BitboardType;
+
+static inline constexpr BitboardType SquareToBitboard( int nSquare )
+{
+	return( 1ULL << nSquare );
+}
+
+
+static inline int PopCount( BitboardType bb )
+{
+#if defined( _MSC_VER )
+	return( (int)__popcnt64( bb ) );
+#else
+	return( __builtin_popcountll( bb ) );
+#endif
+}
+
+
+// Returns the index of the lowest set bit.  bb must not be zero.
+
+static inline int BitScanForward( BitboardType bb )
+{
+#if defined( _MSC_VER )
+	unsigned long ulIndex = 0;
+
+	_BitScanForward64( &ulIndex, bb );
+	return( (int)ulIndex );
+#else
+	return( __builtin_ctzll( bb ) );
+#endif
+}
+
+
+// Mirrors the set of squares top to bottom, ie. exchanges rows 0 and 7, 1 and 6, etc.
+
+static inline BitboardType FlipBitboardVertically( BitboardType bb )
+{
+#if defined( _MSC_VER )
+	return( _byteswap_uint64( bb ) );
+#else
+	return( __builtin_bswap64( bb ) );
+#endif
+}
+
+
+// Removes the lowest set bit from bb and returns its index.
+
+static inline int PopLowestBit( BitboardType & bb )
+{
+	const int knIndex = BitScanForward( bb );
+
+	bb &= bb - 1;
+	return( knIndex );
+}
+
+
 enum GeneratedMoveType
 {
 	eGenMoveType_All = 0,
-	eGenMoveType_Attacking,	// A move that could capture an opposing piece on the dest. square, if there was such a piece there.  Excludes castling and straight-forward pawn movement.
-	eGenMoveType_Capturing	// A move that does capture an opposing piece.
+	eGenMoveType_Capturing,	// A move that does capture an opposing piece, or a pawn promotion.
+	eGenMoveType_Quiet		// Any other move, including castling.
 };
 
 
@@ -33,7 +123,11 @@ static inline void Assert( bool b )
 
 	if( !b )
 	{
+#if defined( _MSC_VER )
 		__asm int 3
+#else
+		abort();
+#endif
 	}
 }
 #elif 1
@@ -51,28 +145,28 @@ public:
 	int m_nDX;
 	int m_nDY;
 
-	C2DVector( int nDX, int nDY );
+	constexpr C2DVector( int nDX, int nDY );
 
-	C2DVector( const C2DVector & Src );
+	constexpr C2DVector( const C2DVector & Src );
 
 	C2DVector & operator=( const C2DVector & Src );
 
 	bool operator==( const C2DVector & Src ) const;
 
-	inline int GetDX( void ) const { return( m_nDX ); }
+	inline constexpr int GetDX( void ) const { return( m_nDX ); }
 
-	inline int GetDY( void ) const { return( m_nDY ); }
+	inline constexpr int GetDY( void ) const { return( m_nDY ); }
 };
 
 
-C2DVector::C2DVector( int nDX, int nDY )
+constexpr C2DVector::C2DVector( int nDX, int nDY )
 	: m_nDX( nDX ),
 		m_nDY( nDY )
 {
 }
 
 
-C2DVector::C2DVector( const C2DVector & Src )
+constexpr C2DVector::C2DVector( const C2DVector & Src )
 	: m_nDX( Src.m_nDX ),
 		m_nDY( Src.m_nDY )
 {
@@ -98,6 +192,39 @@ bool C2DVector::operator==( const C2DVector & Src ) const
 }
 
 
+// The direction sets, which are shared by all games.  The queen uses the king's directions.
+
+static constexpr C2DVector caStraightDirections[4] =
+{
+	C2DVector( 1, 0 ), C2DVector( -1, 0 ), C2DVector( 0, 1 ), C2DVector( 0, -1 )
+};
+
+static constexpr C2DVector caDiagonalDirections[4] =
+{
+	C2DVector( 1, 1 ), C2DVector( -1, 1 ), C2DVector( 1, -1 ), C2DVector( -1, -1 )
+};
+
+static constexpr C2DVector caKingDirections[8] =
+{
+	C2DVector( 1, 0 ), C2DVector( -1, 0 ), C2DVector( 0, 1 ), C2DVector( 0, -1 ),
+	C2DVector( 1, 1 ), C2DVector( -1, 1 ), C2DVector( 1, -1 ), C2DVector( -1, -1 )
+};
+
+static constexpr C2DVector caKnightDirections[8] =
+{
+	C2DVector( 2, 1 ), C2DVector( 2, -1 ), C2DVector( -2, 1 ), C2DVector( -2, -1 ),
+	C2DVector( 1, 2 ), C2DVector( -1, 2 ), C2DVector( 1, -2 ), C2DVector( -1, -2 )
+};
+
+// Indexed by player ID: White's pawns capture towards row 7, Black's towards row 0.
+
+static constexpr C2DVector caPawnCaptureDirections[2][2] =
+{
+	{ C2DVector( -1, 1 ), C2DVector( 1, 1 ) },
+	{ C2DVector( -1, -1 ), C2DVector( 1, -1 ) }
+};
+
+
 enum PieceTypeType
 {
 	ePieceType_King = 0,
@@ -111,872 +238,7128 @@ enum PieceTypeType
 };
 
 
-class CMove
-{
-	// Move Table == an array of 7 list<CMove>
-public:
-	int m_nSrcSquare;	// == 8 * row + col
-	int m_nDstSquare;
-	PieceTypeType m_PromotedTo;
-}; // class CMove
-
+// **** Sliding Piece Attacks ****
 
-// **** Class CPieceArchetype ****
+// The squares attacked by a bishop or rook are looked up in precomputed
+// tables ("fancy" magic bitboards): the occupancy of the squares on the
+// piece's rays, excluding the edge squares that cannot block anything, is
+// multiplied by a magic number and shifted to give an index into the
+// square's slice of the table.  With BMI2, PEXT computes the index directly.
 
-class CPieceArchetype
+class CMagicSquare
 {
-private:
-	void AddAllOrientations( const C2DVector & Dir );
-
 public:
-	PieceTypeType m_PieceType;
-	char m_Printable;		// Printable representation (upper case).
-	double m_dValue;
-	bool m_bUnlimitedRange;	// true for Bishop, Rook, Queen.
-	vector<C2DVector> m_Directions;
+	BitboardType m_bbMask;			// The squares whose occupancy matters.
+	BitboardType m_bbMagic;
+	BitboardType * m_pAttacks;		// This square's slice of the attack table.
+	int m_nShift;					// 64 - PopCount( m_bbMask ).
 
-	CPieceArchetype( PieceTypeType PieceType, int nOwner );
-}; // class CPieceArchetype
-
-
-CPieceArchetype::CPieceArchetype( PieceTypeType PieceType )
-	: m_PieceType( PieceType ),
-		m_Printable( '?' ),
-		m_dValue( 0 ),
-		m_bUnlimitedRange( false )
-{
-	static const C2DVector StraightVector( 1, 0 );
-	static const C2DVector DiagonalVector( 1, 1 );
-	static const C2DVector KnightVector( 2, 1 );
-
-	switch( m_PieceType )
+	inline unsigned int GetIndex( BitboardType bbOccupancy ) const
 	{
-		case ePieceType_King:
-			m_Printable = 'K';
-			m_dValue = 1000.0;
-			m_bUnlimitedRange = false;
-			AddAllOrientations( StraightVector );
-			AddAllOrientations( DiagonalVector );
-			break;
-
-		case ePieceType_Queen:
-			m_Printable = 'Q';
-			m_dValue = 9.0;
-			m_bUnlimitedRange = true;
-			AddAllOrientations( StraightVector );
-			AddAllOrientations( DiagonalVector );
-			break;
+#if defined( PDCHESS_USE_PEXT )
+		return( (unsigned int)_pext_u64( bbOccupancy, m_bbMask ) );
+#else
+		return( (unsigned int)( ( ( bbOccupancy & m_bbMask ) * m_bbMagic ) >> m_nShift ) );
+#endif
+	}
+}; // class CMagicSquare
 
-		case ePieceType_Rook:
-			m_Printable = 'R';
-			m_dValue = 5.0;
-			m_bUnlimitedRange = true;
-			AddAllOrientations( StraightVector );
-			break;
 
-		case ePieceType_Bishop:
-			m_Printable = 'B';
-			m_dValue = 3.125;
-			m_bUnlimitedRange = true;
-			AddAllOrientations( DiagonalVector );
-			break;
+static const BitboardType cabbRookMagics[cnBoardArea] =
+{
+	0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL,
+	0x0880100008000480ULL, 0x4200100420080200ULL, 0x8100020100080400ULL,
+	0x0200040110886200ULL, 0x0200008040220411ULL, 0x0404800084400220ULL,
+	0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+	0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL,
+	0x0442000102105084ULL, 0x9080010020804100ULL, 0x0040404000201009ULL,
+	0x0000808010002009ULL, 0x2200090021D00100ULL, 0x0008008008040080ULL,
+	0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+	0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL,
+	0x1000100080080080ULL, 0x0442000A00049020ULL, 0x2100040080020080ULL,
+	0x0800120400900148ULL, 0x0010040A00128541ULL, 0x2800804000800030ULL,
+	0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+	0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL,
+	0x0182085882000401ULL, 0x0220204000808000ULL, 0x2860100040024022ULL,
+	0x0001002004110040ULL, 0x99101042000A0020ULL, 0x0004080004008080ULL,
+	0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+	0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL,
+	0x0801100280080480ULL, 0x0242009008200600ULL, 0x1002000489500200ULL,
+	0x0040800200010080ULL, 0x0091800041000080ULL, 0x0000209300488001ULL,
+	0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+	0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL,
+	0x4000002840840112ULL
+};
 
-		case ePieceType_Knight:
-			m_Printable = 'N';
-			m_dValue = 3.0;
-			m_bUnlimitedRange = false;
-			AddAllOrientations( KnightVector );
-			break;
+static const BitboardType cabbBishopMagics[cnBoardArea] =
+{
+	0xA010041108003100ULL, 0x006082020A002900ULL, 0x6810010619200000ULL,
+	0x08281A0520000408ULL, 0x0001104001000400ULL, 0x0018901008048400ULL,
+	0x00040A0210245280ULL, 0x000200210808A402ULL, 0x9140048410821200ULL,
+	0x0800091010820041ULL, 0x20504804832202C0ULL, 0x0100091401081000ULL,
+	0x8021011140000012ULL, 0x0810020804450400ULL, 0x208B0542109008A2ULL,
+	0x0080084A08040204ULL, 0x0040E2A80811244CULL, 0x2505022008008108ULL,
+	0x0430220100420040ULL, 0x010A040420220040ULL, 0x1105000290400000ULL,
+	0x0093001200822120ULL, 0x4000A62048043004ULL, 0x280120048A015004ULL,
+	0x006090002A020814ULL, 0x44042000240800D0ULL, 0x01102800040A4400ULL,
+	0x1004080080220040ULL, 0x0001001011004024ULL, 0x0010044000805040ULL,
+	0x0914041200820100ULL, 0x0004821012821480ULL, 0x0024040500C05021ULL,
+	0x0088611002080200ULL, 0x0116080A00040020ULL, 0x4000020080080080ULL,
+	0x2450450140840040ULL, 0x0000880201484100ULL, 0x0222020404020092ULL,
+	0x8081110600002E00ULL, 0x2842101105000801ULL, 0x1100809008001025ULL,
+	0x00020202221C0400ULL, 0x0422014022009020ULL, 0x0210046102100C00ULL,
+	0xC004008082029102ULL, 0x00AA461801101200ULL, 0x0404080080201108ULL,
+	0x020542108C205002ULL, 0x0410544804100100ULL, 0x0040910841100000ULL,
+	0x0400200042021100ULL, 0x00004204850400C0ULL, 0x0200100410A42102ULL,
+	0x1040020801210102ULL, 0x0805040410420000ULL, 0x2884804130100200ULL,
+	0x800C262201242000ULL, 0x1058000194108800ULL, 0x0014221054420204ULL,
+	0x0104000012A02200ULL, 0x0200881003300100ULL, 0x0140400202840100ULL,
+	0x0402020801010201ULL
+};
 
-		case ePieceType_Pawn:
-			m_Printable = 'P';
-			m_dValue = 1.0;
-			m_bUnlimitedRange = false;
-			// Leave Direction vector blank.
-			break;
+static CMagicSquare gs_aRookMagicSquares[cnBoardArea];
+static CMagicSquare gs_aBishopMagicSquares[cnBoardArea];
+static BitboardType gs_abbRookAttacks[102400];	// Sum over all squares of 2 ^ PopCount( mask ).
+static BitboardType gs_abbBishopAttacks[5248];
 
-		default:
-			ThrowException( eStatus_InternalError );
-	}
-} // CPieceArchetype::CPieceArchetype()
 
+// Walk the rays one square at a time; used only to fill the tables.
 
-template <class C>
-bool IsMemberOfVector( const C & obj, const vector<C> & vec )
+static BitboardType ComputeSliderAttacks( int nSquare, BitboardType bbOccupancy, const C2DVector kaDirections[4] )
 {
-	const vector<C>::size_type knVecSize = vec.size();
+	BitboardType bbAttacks = 0;
 
-	for( vector<C>::size_type i = 0; i < knVecSize; ++i )
+	for( int i = 0; i < 4; ++i )
 	{
+		int nRow = nSquare / 8 + kaDirections[i].GetDY();
+		int nCol = nSquare % 8 + kaDirections[i].GetDX();
 
-		if( vec[i] == obj )
+		while( nRow >= 0  &&  nRow < 8  &&  nCol >= 0  &&  nCol < 8 )
 		{
-			return( true );
-		}
-	}
-
-	return( false );
-}
+			const BitboardType kbbSquare = SquareToBitboard( nRow * 8 + nCol );
 
+			bbAttacks |= kbbSquare;
 
-void CPieceArchetype::AddAllOrientations( const C2DVector & Dir )
-{
+			if( ( bbOccupancy & kbbSquare ) != 0 )
+			{
+				break;
+			}
 
-	if( IsMemberOfVector( Dir, m_Directions ) )
-	{
-		return;	// The seed vector is already in the vector vector.
+			nRow += kaDirections[i].GetDY();
+			nCol += kaDirections[i].GetDX();
+		}
 	}
 
-	vector<C2DVector>::size_type i = 0;
-	const vector<C2DVector>::size_type knVectorStart = m_Directions.size();
-	vector<C2DVector>::size_type nVectorEnd = 0;
+	return( bbAttacks );
+}
 
-	m_Directions.push_back( Dir );
 
-	// 1) Reflect in the X axis.
-	nVectorEnd = m_Directions.size();
+static void InitializeMagicSquares( CMagicSquare * aMagicSquares, const BitboardType * kabbMagics,
+	BitboardType * pAttacks, const C2DVector kaDirections[4] )
+{
+	static const BitboardType kbbRows1And8 = 0xFF000000000000FFULL;
+	static const BitboardType kbbColsAAndH = 0x8181818181818181ULL;
 
-	for( i = knVectorStart; i < nVectorEnd; ++i )
+	for( int nSquare = 0; nSquare < cnBoardArea; ++nSquare )
 	{
-		const C2DVector NewDir( m_Directions[i].GetDX(), - m_Directions[i].GetDY() );
-
-		if( !IsMemberOfVector( NewDir, m_Directions ) )
-		{
-			m_Directions.push_back( NewDir );
-		}
-	}
+		CMagicSquare & magicSquare = aMagicSquares[nSquare];
+		const BitboardType kbbEdges = ( kbbRows1And8 & ~( 0xFFULL << ( nSquare & ~7 ) ) ) |
+			( kbbColsAAndH & ~( 0x0101010101010101ULL << ( nSquare & 7 ) ) );
+		BitboardType bbSubset = 0;
 
-	// 2) Reflect in the Y axis.
-	nVectorEnd = m_Directions.size();
+		magicSquare.m_bbMask = ComputeSliderAttacks( nSquare, 0, kaDirections ) & ~kbbEdges;
+		magicSquare.m_bbMagic = kabbMagics[nSquare];
+		magicSquare.m_nShift = 64 - PopCount( magicSquare.m_bbMask );
+		magicSquare.m_pAttacks = pAttacks;
 
-	for( i = knVectorStart; i < nVectorEnd; ++i )
-	{
-		const C2DVector NewDir( - m_Directions[i].GetDX(), m_Directions[i].GetDY() );
+		// Enumerate every subset of the mask (the Carry-Rippler trick).
 
-		if( !IsMemberOfVector( NewDir, m_Directions ) )
+		do
 		{
-			m_Directions.push_back( NewDir );
+			magicSquare.m_pAttacks[magicSquare.GetIndex( bbSubset )] =
+				ComputeSliderAttacks( nSquare, bbSubset, kaDirections );
+			bbSubset = ( bbSubset - magicSquare.m_bbMask ) & magicSquare.m_bbMask;
 		}
-	}
-
-	// 3) Reflect in the line X == Y.
-	nVectorEnd = m_Directions.size();
-
-	for( i = knVectorStart; i < nVectorEnd; ++i )
-	{
-		const C2DVector NewDir( m_Directions[i].GetDY(), m_Directions[i].GetDX() );
+		while( bbSubset != 0 );
 
-		if( !IsMemberOfVector( NewDir, m_Directions ) )
-		{
-			m_Directions.push_back( NewDir );
-		}
+		pAttacks += 1 << PopCount( magicSquare.m_bbMask );
 	}
-} // CPieceArchetype::AddAllOrientations()
-
+}
 
-// **** Class CPiece ****
 
-class CPlayer;
+// The tables are filled once, before main() runs.
 
-class CPiece
+class CSliderAttacksInitializer
 {
 public:
-	CPieceArchetype * m_pArchetype;
-	CPlayer & m_Owner; //int m_nOwner;				// 0 for White, 1 for Black.
-	int m_nRow;
-	int m_nCol;
-	bool m_bCaptured;
-}; // class CPiece
-
+	CSliderAttacksInitializer( void )
+	{
+		InitializeMagicSquares( gs_aRookMagicSquares, cabbRookMagics, gs_abbRookAttacks, caStraightDirections );
+		InitializeMagicSquares( gs_aBishopMagicSquares, cabbBishopMagics, gs_abbBishopAttacks, caDiagonalDirections );
+	}
+};
 
-// **** Class CPlayer ****
+static const CSliderAttacksInitializer gs_SliderAttacksInitializer;
 
-class CGame;
 
-class CPlayer
+static inline BitboardType GetRookAttacks( int nSquare, BitboardType bbOccupancy )
 {
-private:
-	int SquareToPieceTypeIndex( const CPiece * pSquare ) const; // Could be static.
-
-public:
-	const int m_knSelfID;				// 0 for White, 1 for Black.
-	CGame & m_Game;
-	CPlayer & m_Opponent;
-	bool m_bCanCastleKingside;
-	bool m_bCanCastleQueenside;
-	vector<CPiece> m_Pieces;
-
-	CPlayer( int nSelfID, CGame & game, CPlayer & opponent );
-	void CreatePieces( void );
-	double TotalMaterialValue( void ) const;
-	double FindBestMove( CMove * pBestMove, int nMaxPly,
-		bool bDoAlphaBetaPruning, double dParent, double dBestUncleLine );
-};
-
+	const CMagicSquare & kMagicSquare = gs_aRookMagicSquares[nSquare];
 
-CPlayer::CPlayer( int nSelfID, CGame & game, CPlayer & opponent )
-	: m_knSelfID( nSelfID ),
-		m_Game( game ),
-		m_Opponent( opponent ),
-		m_bCanCastleKingside( true ),
-		m_bCanCastleQueenside( true )
-{
-	CreatePieces();
+	return( kMagicSquare.m_pAttacks[kMagicSquare.GetIndex( bbOccupancy )] );
 }
 
 
-double CPlayer::TotalMaterialValue( void ) const
+static inline BitboardType GetBishopAttacks( int nSquare, BitboardType bbOccupancy )
 {
-	return( 0.0 );	// TAW_TODO.
+	const CMagicSquare & kMagicSquare = gs_aBishopMagicSquares[nSquare];
+
+	return( kMagicSquare.m_pAttacks[kMagicSquare.GetIndex( bbOccupancy )] );
 }
 
-int CPlayer::SquareToPieceTypeIndex( const CPiece * pSquare ) const
-{
 
-	if( pSquare == 0 )
-	{
-		// There is no piece on this square.
-		return( 6 );
-	}
+static inline BitboardType GetSliderAttacks( PieceTypeType PieceType, int nSquare, BitboardType bbOccupancy )
+{
 
-	switch( pSquare->m_pArchetype->m_PieceType )
+	switch( PieceType )
 	{
-		case ePieceType_King:
-			return( 0 );
-
 		case ePieceType_Queen:
-			return( 1 );
+			return( GetRookAttacks( nSquare, bbOccupancy ) | GetBishopAttacks( nSquare, bbOccupancy ) );
 
 		case ePieceType_Rook:
-			return( 2 );
+			return( GetRookAttacks( nSquare, bbOccupancy ) );
 
 		case ePieceType_Bishop:
-			return( 3 );
-
-		case ePieceType_Knight:
-			return( 4 );
-
-		case ePieceType_Pawn:
-			return( 5 );
+			return( GetBishopAttacks( nSquare, bbOccupancy ) );
 
 		default:
-			// Error.
 			break;
 	}
 
-	return( 6 );
+	return( 0 );
 }
 
 
-// **** Class CGame ****
+// **** Leaping Piece Attacks ****
 
-class CGame
+// The squares attacked by kings, knights and pawns, computed at compile time.
+
+class CLeaperAttackTables
 {
 private:
-	// King, Queen, Rook, Bishop, Knight, Pawn.
-	const CPieceArchetype m_KingArchetype;
-	const CPieceArchetype m_QueenArchetype;
-	const CPieceArchetype m_RookArchetype;
-	const CPieceArchetype m_BishopArchetype;
-	const CPieceArchetype m_KnightArchetype;
-	const CPieceArchetype m_PawnArchetype;
-	CPiece * m_aBoard[cnBoardArea];
+	static constexpr BitboardType ComputeLeaperAttacks( int nSquare, const C2DVector * kaDirections, int nNumDirections )
+	{
+		BitboardType bbAttacks = 0;
 
-	CPlayer m_WhitePlayer;
-	CPlayer m_BlackPlayer;
+		for( int i = 0; i < nNumDirections; ++i )
+		{
+			const int knRow = nSquare / 8 + kaDirections[i].GetDY();
+			const int knCol = nSquare % 8 + kaDirections[i].GetDX();
 
-	int m_nPawnCapturableViaEnPassant;
+			if( knRow >= 0  &&  knRow < 8  &&  knCol >= 0  &&  knCol < 8 )
+			{
+				bbAttacks |= SquareToBitboard( knRow * 8 + knCol );
+			}
+		}
 
-	void InitializeBoard( void );
-	void PrintBoard( void ) const;
+		return( bbAttacks );
+	}
 
 public:
+	BitboardType m_abbKingAttacks[cnBoardArea];
+	BitboardType m_abbKnightAttacks[cnBoardArea];
+	BitboardType m_abbPawnAttacks[2][cnBoardArea];	// Indexed by player ID, then by the pawn's square.
+
+	constexpr CLeaperAttackTables( void )
+		: m_abbKingAttacks(),
+			m_abbKnightAttacks(),
+			m_abbPawnAttacks()
+	{
+
+		for( int nSquare = 0; nSquare < cnBoardArea; ++nSquare )
+		{
+			m_abbKingAttacks[nSquare] = ComputeLeaperAttacks( nSquare, caKingDirections, 8 );
+			m_abbKnightAttacks[nSquare] = ComputeLeaperAttacks( nSquare, caKnightDirections, 8 );
+			m_abbPawnAttacks[0][nSquare] = ComputeLeaperAttacks( nSquare, caPawnCaptureDirections[0], 2 );
+			m_abbPawnAttacks[1][nSquare] = ComputeLeaperAttacks( nSquare, caPawnCaptureDirections[1], 2 );
+		}
+	}
+}; // class CLeaperAttackTables
 
-	CGame( void );
 
-	void Play( void ) throw( CException );
+static constexpr CLeaperAttackTables cLeaperAttackTables;
 
-}; // class CGame
 
+// The squares attacked by a piece other than a pawn.
 
-void CPlayer::CreatePieces( void )
+static inline BitboardType GetPieceAttacks( PieceTypeType PieceType, int nSquare, BitboardType bbOccupancy )
 {
-	const int knBackRow = 7 * m_knSelfID;
-	const int knFrontRow = 5 * m_knSelfID + 1;
 
-	m_Pieces.push_back( CPiece( m_kGame.m_RookArchetype, *this, knBackRow, 0 ) );
-	m_Pieces.push_back( CPiece( m_kGame.m_KnightArchetype, *this, knBackRow, 1 ) );
-	m_Pieces.push_back( CPiece( m_kGame.m_BishopArchetype, *this, knBackRow, 2 ) );
-	m_Pieces.push_back( CPiece( m_kGame.m_QueenArchetype, *this, knBackRow, 3 ) );
-	m_Pieces.push_back( CPiece( m_kGame.m_KingArchetype, *this, knBackRow, 4 ) );
-	m_Pieces.push_back( CPiece( m_kGame.m_BishopArchetype, *this, knBackRow, 5 ) );
-	m_Pieces.push_back( CPiece( m_kGame.m_KnightArchetype, *this, knBackRow, 6 ) );
-	m_Pieces.push_back( CPiece( m_kGame.m_RookArchetype, *this, knBackRow, 7 ) );
-
-	for( int i = 0; i < 8; ++i )
+	switch( PieceType )
 	{
-		m_Pieces.push_back( CPiece( m_kGame.m_PawnArchetype, *this, knFrontRow, i ) );
+		case ePieceType_King:
+			return( cLeaperAttackTables.m_abbKingAttacks[nSquare] );
+
+		case ePieceType_Knight:
+			return( cLeaperAttackTables.m_abbKnightAttacks[nSquare] );
+
+		default:
+			break;
 	}
+
+	return( GetSliderAttacks( PieceType, nSquare, bbOccupancy ) );
 }
 
 
-void CPlayer::GenerateMoves( vector<CMove> & generatedMoves, bool bGenerateAttackingMovesOnly )
+// The squares strictly between two squares on a rank, file or diagonal;
+// 0 if the squares are not on a common line.
+
+static inline BitboardType GetSquaresBetween( int nSquare1, int nSquare2 )
 {
-	// Generate the vector of all possible legal moves, including castling.
-	// The moves are sorted by the value of the captured piece, if any;
-	// King captures come first, since they end the game.
-	vector<CMove> GeneratedMovesAList[7];
-	const int knBackRow = 7 * m_knSelfID;
-	const int knPawnStartRow = 5 * m_knSelfID + 1;
-	const int knPawnPromotionRow = 7 * ( 1 - m_knSelfID );
-	const int knPawnRowVector = 1 - 2 * m_knSelfID;
-	const int knNumPieces = m_Pieces.size();
-	int i = 0;
+	const BitboardType kbbSquare1 = SquareToBitboard( nSquare1 );
+	const BitboardType kbbSquare2 = SquareToBitboard( nSquare2 );
 
-	for( i = 0; i < knNumPieces; ++i )
+	if( ( GetRookAttacks( nSquare1, 0 ) & kbbSquare2 ) != 0 )
 	{
-		const CPiece * const kpPiece = &m_Pieces[i];
-		const int knSrcIndex = kpPiece->m_nRow * 8 + kpPiece->m_nCol;
+		return( GetRookAttacks( nSquare1, kbbSquare2 ) & GetRookAttacks( nSquare2, kbbSquare1 ) );
+	}
+	else if( ( GetBishopAttacks( nSquare1, 0 ) & kbbSquare2 ) != 0 )
+	{
+		return( GetBishopAttacks( nSquare1, kbbSquare2 ) & GetBishopAttacks( nSquare2, kbbSquare1 ) );
+	}
 
-		if( kpPiece->m_pArchetype->m_PieceType == ePieceType_Pawn )
-		{
-			// Generate all possible legal pawn moves.
-			const int knSrcRow = kpPiece->m_nRow;
-			const int knSrcCol = kpPiece->m_nCol;
-			int nDstRow = 0;
-			int nDstCol = 0;
-			const CPiece * pDstSquare = 0;
+	return( 0 );
+}
 
-			// For pawns, be aware of:
-			// 1) 1- or 2-square initial move ahead;
-			// 2) Move forward, capture diagonally;
-			// 3) Capturing en passant;
-			// 4) Pawn promotion to knight, bishop, rook, or queen.
 
-			if( !bGenerateAttackingMovesOnly )
-			{
-				// Try to move the pawn ahead one square.
-				nDstRow = knSrcRow + knPawnRowVector;
-				nDstCol = knSrcCol;
+// The whole rank, file or diagonal through two squares, from edge to edge;
+// 0 if the squares are not on a common line.
 
-				if( nDstRow >= 0  &&  nDstRow < 8 )
-				{
-					pDstSquare = m_Game.m_aBoard[nDstRow * 8 + nDstCol];
+static inline BitboardType GetLineThrough( int nSquare1, int nSquare2 )
+{
+	const BitboardType kbbSquares = SquareToBitboard( nSquare1 ) | SquareToBitboard( nSquare2 );
 
-					if( pDstSquare == 0 )
-					{
-						// Move the pawn ahead one square.
+	if( ( GetRookAttacks( nSquare1, 0 ) & kbbSquares ) != 0 )
+	{
+		return( ( GetRookAttacks( nSquare1, 0 ) & GetRookAttacks( nSquare2, 0 ) ) | kbbSquares );
+	}
+	else if( ( GetBishopAttacks( nSquare1, 0 ) & kbbSquares ) != 0 )
+	{
+		return( ( GetBishopAttacks( nSquare1, 0 ) & GetBishopAttacks( nSquare2, 0 ) ) | kbbSquares );
+	}
 
-						if( nDstRow == knPawnPromotionRow )
-						{
-							// Promote the pawn (without capture).
-							GeneratedMovesAList[6].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Queen ) );
-							GeneratedMovesAList[6].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Rook ) );
-							GeneratedMovesAList[6].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Bishop ) );
-							GeneratedMovesAList[6].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Knight ) );
-						}
-						else
-						{
-							GeneratedMovesAList[6].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Null ) );
-						}
+	return( 0 );
+}
 
-						// Try to move the pawn ahead two squares if it's the pawn's first move.
-						nDstRow = knSrcRow + 2 * knPawnRowVector;
 
-						// Some of these conditions are redundant.
-						if( knSrcRow == knPawnStartRow /* &&  nDstRow >= 0  &&  nDstRow < 8 */ )
-						{
-							pDstSquare = m_Game.m_aBoard[nDstRow * 8 + nDstCol];
-
-							if( pDstSquare == 0 )
-							{
-								// Move the pawn ahead two squares.
-								// Pawn promotion is impossible here.
-								GeneratedMovesAList[6].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Null ) );
-							}
-						}
-					}
-				}
-			}
+// **** Zobrist Hashing ****
 
-			// Try to attack diagonally.
-			static const int kanDX[2] = { -1, 1 };
+// A position's hash key is the XOR of one pseudo-random key for each piece
+// on each square, plus keys for the player to move, the castling flags
+// and the pawn capturable via en passant.  Making a move XORs in only the
+// keys that change.  The keys are generated at compile time (SplitMix64).
 
-			for( int j = 0; j < 2; ++j )
-			{
-				nDstRow = knSrcRow + knPawnRowVector;
-				nDstCol = knSrcCol + kanDX[j];
+typedef unsigned long long HashKeyType;
 
-				if( nDstRow >= 0  &&  nDstRow < 8  &&
-						nDstCol >= 0  &&  nDstCol < 8 )
-				{
-					pDstSquare = m_Game.m_aBoard[nDstRow * 8 + nDstCol];
+class CZobristKeys
+{
+private:
+	static constexpr HashKeyType GenerateKey( HashKeyType & nState )
+	{
+		HashKeyType nKey = ( nState += 0x9E3779B97F4A7C15ULL );
 
-					if( pDstSquare != 0  &&  &pDstSquare->m_Owner != this )
-					{
-						// Attack diagonally and capture the piece on the destination square.
-						const int knPieceTypeIndex = SquareToPieceTypeIndex( pDstSquare );
+		nKey = ( nKey ^ ( nKey >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+		nKey = ( nKey ^ ( nKey >> 27 ) ) * 0x94D049BB133111EBULL;
+		return( nKey ^ ( nKey >> 31 ) );
+	}
 
-						if( nDstRow == knPawnPromotionRow )
-						{
-							// Promote the pawn (with capture).
-							GeneratedMovesAList[knPieceTypeIndex].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Queen ) );
-							GeneratedMovesAList[knPieceTypeIndex].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Rook ) );
-							GeneratedMovesAList[knPieceTypeIndex].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Bishop ) );
-							GeneratedMovesAList[knPieceTypeIndex].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Knight ) );
-						}
-						else
-						{
-							GeneratedMovesAList[knPieceTypeIndex].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Null ) );
-						}
-					}
-				}
-			}
+public:
+	HashKeyType m_anPieceKeys[2][eNumPieceTypes][cnBoardArea];	// Indexed by player ID, piece type and square.
+	HashKeyType m_anCastlingKeys[2][2];			// Indexed by player ID, then 0 for kingside, 1 for queenside.
+	HashKeyType m_anCastlingRightsKeys[16];		// The combined keys of each set of castling rights (see CastlingRightsType).
+	HashKeyType m_anEnPassantKeys[cnBoardSize];	// Indexed by the column of the pawn capturable via en passant.
+	HashKeyType m_nBlackToMoveKey;
+
+	constexpr CZobristKeys( void )
+		: m_anPieceKeys(),
+			m_anCastlingKeys(),
+			m_anCastlingRightsKeys(),
+			m_anEnPassantKeys(),
+			m_nBlackToMoveKey( 0 )
+	{
+		HashKeyType nState = 0x7064636865737332ULL;	// "pdchess2".
 
-			// Try to capture en passant.
+		for( int i = 0; i < 2; ++i )
+		{
 
-			if( m_Game.m_nPawnCapturableViaEnPassant >= 0  &&  m_Game.m_nPawnCapturableViaEnPassant < 64 )
+			for( int j = 0; j < eNumPieceTypes; ++j )
 			{
-				const int knCapturablePawnRow = m_Game.m_nPawnCapturableViaEnPassant % 8;
-				const int knCapturablePawnCol = m_Game.m_nPawnCapturableViaEnPassant / 8;
 
-				// Assert( knCapturablePawnRow == 5 - m_knSelfID );
-
-				if( knCapturablePawnRow == knSrcRow  &&
-						abs( knCapturablePawnCol - knSrcCol ) == 1 )
+				for( int k = 0; k < cnBoardArea; ++k )
 				{
-					nDstRow = knSrcRow + knPawnRowVector;
-					nDstCol = knCapturablePawnCol;
-
-					// Index 5: A pawn is capturing another pawn.  No promotion.
-					GeneratedMovesAList[5].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Null ) );
+					m_anPieceKeys[i][j][k] = GenerateKey( nState );
 				}
 			}
+
+			m_anCastlingKeys[i][0] = GenerateKey( nState );
+			m_anCastlingKeys[i][1] = GenerateKey( nState );
 		}
-		else
+
+		for( int i = 0; i < 16; ++i )
 		{
-			// Use the piece's vector of direction vectors.
-			const vector<C2DVector> & directions = kpPiece->m_pArchetype->m_Directions;
-			const int knNumDirections = directions.size();
 
-			for( int j = 0; j < knNumDirections; ++j )
+			for( int j = 0; j < 4; ++j )
 			{
-				const C2DVector & CurrentDirection = direction[j];
-				int nDstRow = kpPiece->m_nRow;
-				int nDstCol = kpPiece->m_nCol;
 
-				do
+				if( ( i & ( 1 << j ) ) != 0 )
 				{
-					nDstRow += CurrentDirection.GetDY();
-					nDstCol += CurrentDirection.GetDX();
+					m_anCastlingRightsKeys[i] ^= m_anCastlingKeys[j / 2][j % 2];
+				}
+			}
+		}
 
-					if( nDstRow < 0  ||  nDstRow >= 8  ||
-							nDstCol < 0  ||  nDstCol >= 8 )
-					{
-						// We've moved off the board.
-						break;
-					}
+		for( int i = 0; i < cnBoardSize; ++i )
+		{
+			m_anEnPassantKeys[i] = GenerateKey( nState );
+		}
 
-					const CPiece * const kpDstSquare = m_Game.m_aBoard[nDstRow * 8 + nDstCol];
+		m_nBlackToMoveKey = GenerateKey( nState );
+	}
+}; // class CZobristKeys
 
-					if( kpDstSquare != 0  &&  &kpDstSquare->m_Owner == this )
-					{
-						// We've bumped into another one of our own pieces.
-						break;
-					}
 
-					// We have a legal move!  Add it to the table.
-					GeneratedMovesAList[SquareToPieceTypeIndex( kpDstSquare )].push_back( CMove( knSrcIndex, nDstRow * 8 + nDstCol, ePieceType_Null ) );
+static constexpr CZobristKeys cZobristKeys;
 
-					if( kpDstSquare != 0 )
-					{
-						// The move we just generated was a capture; we can go no further.
-						break;
-					}
-				}
-				while( kpPiece->m_pArchetype->m_bUnlimitedRange );
 
+// A move, packed into 16 bits:
+// Bits  0 -  5 : The source square (8 * row + col).
+// Bits  6 - 11 : The destination square.  For castling, these are the king's squares.
+// Bits 12 - 15 : The flags (see MoveFlagsType).
+// CMove() (a1 to a1) is not a move; it means "no move".
+
+enum MoveFlagsType
+{
+	eMoveFlags_Normal = 0,
+	eMoveFlags_EnPassant,
+	eMoveFlags_Castling,
+	eMoveFlags_Promotion = 8		// Plus the promotion piece type, less one; see CMove::GetPromotedTo().
+};
+
+
+class CMove
+{
+public:
+	unsigned short m_nData;
+
+	CMove( void )
+		: m_nData( 0 )
+	{
+	}
+
+	CMove( int nSrcSquare, int nDstSquare, MoveFlagsType Flags = eMoveFlags_Normal )
+		: m_nData( (unsigned short)( nSrcSquare | nDstSquare << 6 | Flags << 12 ) )
+	{
+	}
+
+	CMove( int nSrcSquare, int nDstSquare, PieceTypeType PromotedTo )
+		: m_nData( (unsigned short)( nSrcSquare | nDstSquare << 6 |
+			( PromotedTo == ePieceType_Null ? eMoveFlags_Normal : eMoveFlags_Promotion + PromotedTo - 1 ) << 12 ) )
+	{
+	}
+
+	inline int GetSrcSquare( void ) const
+	{
+		return( m_nData & 0x3F );
+	}
+
+	inline int GetDstSquare( void ) const
+	{
+		return( ( m_nData >> 6 ) & 0x3F );
+	}
+
+	inline int GetFlags( void ) const
+	{
+		return( m_nData >> 12 );
+	}
+
+	inline bool IsCastling( void ) const
+	{
+		return( GetFlags() == eMoveFlags_Castling );
+	}
+
+	inline bool IsEnPassant( void ) const
+	{
+		return( GetFlags() == eMoveFlags_EnPassant );
+	}
+
+	inline bool IsPromotion( void ) const
+	{
+		return( ( GetFlags() & eMoveFlags_Promotion ) != 0 );
+	}
+
+	inline PieceTypeType GetPromotedTo( void ) const
+	{
+		return( IsPromotion() ? (PieceTypeType)( ( GetFlags() & 0x07 ) + 1 ) : ePieceType_Null );
+	}
+
+	inline bool operator==( const CMove & Src ) const
+	{
+		return( m_nData == Src.m_nData );
+	}
+}; // class CMove
+
+
+// **** Class CMoveList ****
+
+// A fixed-capacity list of moves, so that generating moves never allocates memory.
+// No legal position has more than 218 moves.
+
+static const int cnMaxNumMoves = 256;
+
+
+class CMoveList
+{
+public:
+	CMove m_aMoves[cnMaxNumMoves];
+	int m_anScores[cnMaxNumMoves];		// For ordering the moves; see CMovePicker.
+	int m_nNumMoves;
+
+	CMoveList( void )
+		: m_nNumMoves( 0 )
+	{
+	}
+
+	inline void Clear( void )
+	{
+		m_nNumMoves = 0;
+	}
+
+	inline void Add( const CMove & move )
+	{
+		Assert( m_nNumMoves < cnMaxNumMoves );
+		m_aMoves[m_nNumMoves++] = move;
+	}
+
+	inline int Size( void ) const
+	{
+		return( m_nNumMoves );
+	}
+
+	inline bool IsEmpty( void ) const
+	{
+		return( m_nNumMoves == 0 );
+	}
+
+	inline const CMove & operator[]( int i ) const
+	{
+		return( m_aMoves[i] );
+	}
+}; // class CMoveList
+
+
+// **** Scores ****
+
+// All values are integers, in centipawns, from the point of view of the player to move.
+// A position in which the player to move is checkmated is worth
+// -( cnMateScore - nPly ), where nPly is its distance from the root,
+// so that the search prefers the shortest mate and the longest defence.
+
+typedef int ScoreType;
+
+static const ScoreType cnInfiniteScore = 32000;		// Beyond any value that the search can return.
+static const ScoreType cnMateScore = 30000;			// Minus the value of being checkmated at the root.
+static const ScoreType cnMinMateScore = cnMateScore - 1000;	// Values beyond this are mates.
+
+
+inline bool IsMateScore( ScoreType nScore )
+{
+	return( nScore >= cnMinMateScore  ||  nScore <= -cnMinMateScore );
+}
+
+
+// The transposition table holds mate values relative to the position in which
+// they are stored, rather than to the root, since the position may be reached
+// at a different distance from the root later.
+
+inline ScoreType ScoreToTranspositionTable( ScoreType nScore, int nPly )
+{
+
+	if( nScore >= cnMinMateScore )
+	{
+		return( nScore + nPly );
+	}
+	else if( nScore <= -cnMinMateScore )
+	{
+		return( nScore - nPly );
+	}
+
+	return( nScore );
+}
+
+
+inline ScoreType ScoreFromTranspositionTable( ScoreType nScore, int nPly )
+{
+
+	if( nScore >= cnMinMateScore )
+	{
+		return( nScore - nPly );
+	}
+	else if( nScore <= -cnMinMateScore )
+	{
+		return( nScore + nPly );
+	}
+
+	return( nScore );
+}
+
+
+string ScoreToString( ScoreType nScore )
+{
+	// In the form used by the "info" lines: "cp <centipawns>" or "mate <moves>",
+	// where a negative number of moves means that the player to move is being mated.
+
+	if( nScore >= cnMinMateScore )
+	{
+		return( "mate " + to_string( ( cnMateScore - nScore + 1 ) / 2 ) );
+	}
+	else if( nScore <= -cnMinMateScore )
+	{
+		return( "mate " + to_string( -( ( cnMateScore + nScore ) / 2 ) ) );
+	}
+
+	return( "cp " + to_string( nScore ) );
+}
+
+
+// **** Class CPieceArchetype ****
+
+class CPieceArchetype
+{
+public:
+	PieceTypeType m_PieceType;
+	char m_Printable;		// Printable representation (upper case).
+	ScoreType m_nValue;		// In centipawns.
+	bool m_bUnlimitedRange;	// true for Bishop, Rook, Queen.
+	const C2DVector * m_kaDirections;
+	int m_nNumDirections;
+}; // class CPieceArchetype
+
+
+// One read-only table, indexed by PieceTypeType, shared by all games.
+
+static constexpr CPieceArchetype caPieceArchetypes[eNumPieceTypes] =
+{
+	{ ePieceType_King, 'K', 20000, false, caKingDirections, 8 },
+	{ ePieceType_Queen, 'Q', 900, true, caKingDirections, 8 },
+	{ ePieceType_Rook, 'R', 500, true, caStraightDirections, 4 },
+	{ ePieceType_Bishop, 'B', 313, true, caDiagonalDirections, 4 },
+	{ ePieceType_Knight, 'N', 300, false, caKnightDirections, 8 },
+	{ ePieceType_Pawn, 'P', 100, false, 0, 0 }		// Pawns have no direction vectors.
+};
+
+
+// **** Piece-Square Tables ****
+
+// The positional bonus, in centipawns, for a piece of each type on each square.
+// The tables are drawn from White's point of view, with row 7 at the top.
+
+static constexpr int caanPieceSquareTables[eNumPieceTypes][cnBoardArea] =
+{
+	{	// King: stay behind the pawns, preferably castled.
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-30, -40, -40, -50, -50, -40, -40, -30,
+		-20, -30, -30, -40, -40, -30, -30, -20,
+		-10, -20, -20, -20, -20, -20, -20, -10,
+		 20,  20,   0,   0,   0,   0,  20,  20,
+		 20,  30,  10,   0,   0,  10,  30,  20
+	},
+	{	// Queen.
+		-20, -10, -10,  -5,  -5, -10, -10, -20,
+		-10,   0,   0,   0,   0,   0,   0, -10,
+		-10,   0,   5,   5,   5,   5,   0, -10,
+		 -5,   0,   5,   5,   5,   5,   0,  -5,
+		  0,   0,   5,   5,   5,   5,   0,  -5,
+		-10,   5,   5,   5,   5,   5,   0, -10,
+		-10,   0,   5,   0,   0,   0,   0, -10,
+		-20, -10, -10,  -5,  -5, -10, -10, -20
+	},
+	{	// Rook: the seventh row, and the centre files.
+		  0,   0,   0,   0,   0,   0,   0,   0,
+		  5,  10,  10,  10,  10,  10,  10,   5,
+		 -5,   0,   0,   0,   0,   0,   0,  -5,
+		 -5,   0,   0,   0,   0,   0,   0,  -5,
+		 -5,   0,   0,   0,   0,   0,   0,  -5,
+		 -5,   0,   0,   0,   0,   0,   0,  -5,
+		 -5,   0,   0,   0,   0,   0,   0,  -5,
+		  0,   0,   0,   5,   5,   0,   0,   0
+	},
+	{	// Bishop.
+		-20, -10, -10, -10, -10, -10, -10, -20,
+		-10,   0,   0,   0,   0,   0,   0, -10,
+		-10,   0,   5,  10,  10,   5,   0, -10,
+		-10,   5,   5,  10,  10,   5,   5, -10,
+		-10,   0,  10,  10,  10,  10,   0, -10,
+		-10,  10,  10,  10,  10,  10,  10, -10,
+		-10,   5,   0,   0,   0,   0,   5, -10,
+		-20, -10, -10, -10, -10, -10, -10, -20
+	},
+	{	// Knight: the centre, not the rim.
+		-50, -40, -30, -30, -30, -30, -40, -50,
+		-40, -20,   0,   0,   0,   0, -20, -40,
+		-30,   0,  10,  15,  15,  10,   0, -30,
+		-30,   5,  15,  20,  20,  15,   5, -30,
+		-30,   0,  15,  20,  20,  15,   0, -30,
+		-30,   5,  10,  15,  15,  10,   5, -30,
+		-40, -20,   0,   5,   5,   0, -20, -40,
+		-50, -40, -30, -30, -30, -30, -40, -50
+	},
+	{	// Pawn: advance, especially in the centre.
+		  0,   0,   0,   0,   0,   0,   0,   0,
+		 50,  50,  50,  50,  50,  50,  50,  50,
+		 10,  10,  20,  30,  30,  20,  10,  10,
+		  5,   5,  10,  25,  25,  10,   5,   5,
+		  0,   0,   0,  20,  20,   0,   0,   0,
+		  5,  -5, -10,   0,   0, -10,  -5,   5,
+		  5,  10,  10, -20, -20,  10,  10,   5,
+		  0,   0,   0,   0,   0,   0,   0,   0
+	}
+};
+
+
+// The tables above, indexed by player ID, piece type and square (8 * row + col).
+
+class CPieceSquareValues
+{
+public:
+	int m_anValues[2][eNumPieceTypes][cnBoardArea];
+
+	constexpr CPieceSquareValues( void )
+		: m_anValues()
+	{
+
+		for( int i = 0; i < eNumPieceTypes; ++i )
+		{
+
+			for( int nSquare = 0; nSquare < cnBoardArea; ++nSquare )
+			{
+				const int knRow = nSquare / 8;
+				const int knCol = nSquare % 8;
+
+				// Black's tables are White's, reflected top to bottom.
+				m_anValues[0][i][nSquare] = caanPieceSquareTables[i][( 7 - knRow ) * 8 + knCol];
+				m_anValues[1][i][nSquare] = caanPieceSquareTables[i][knRow * 8 + knCol];
+			}
+		}
+	}
+}; // class CPieceSquareValues
+
+
+static constexpr CPieceSquareValues cPieceSquareValues;
+
+
+// **** Class CTranspositionTable ****
+
+// The transposition table remembers the results of earlier searches,
+// keyed by the Zobrist hash key of the position.  The table is an array
+// of cache-line-sized buckets; a key selects one bucket, and any of the
+// bucket's entries may hold it.
+
+enum BoundType
+{
+	eBoundType_None = 0,	// An empty entry.
+	eBoundType_Exact,
+	eBoundType_Lower,		// The search failed high; the value is at least the stored score.
+	eBoundType_Upper		// The search failed low; the value is at most the stored score.
+};
+
+
+static const int cnDefaultTranspositionTableSizeInMB = 16;
+static const int cnCacheLineSize = 64;
+static const int cnGenerationMask = 0x3F;
+
+
+class CTranspositionTableEntry
+{
+public:
+	HashKeyType m_nKey;
+	unsigned long long m_nData;
+
+	// The layout of m_nData:
+	// Bits  0 - 15 : The score (a signed 16-bit ScoreType; mates are relative to this position).
+	// Bits 16 - 31 : The best move (a CMove).
+	// Bits 32 - 39 : The remaining search depth (nMaxPly).
+	// Bits 40 - 41 : The bound type.
+	// Bits 42 - 47 : The generation (the search that stored the entry).
+	// Bits 48 - 63 : Unused.
+
+	static unsigned long long PackData( ScoreType nScore, const CMove & move, int nDepth, BoundType Bound, int nGeneration )
+	{
+		return( (unsigned long long)(unsigned short)nScore |
+			(unsigned long long)move.m_nData << 16 |
+			(unsigned long long)( nDepth & 0xFF ) << 32 |
+			(unsigned long long)Bound << 40 |
+			(unsigned long long)( nGeneration & cnGenerationMask ) << 42 );
+	}
+
+	inline ScoreType GetScore( void ) const
+	{
+		return( (short)( m_nData & 0xFFFF ) );
+	}
+
+	inline CMove GetMove( void ) const
+	{
+		CMove move;
+
+		move.m_nData = (unsigned short)( m_nData >> 16 );
+		return( move );
+	}
+
+	inline int GetDepth( void ) const
+	{
+		return( (int)( m_nData >> 32 ) & 0xFF );
+	}
+
+	inline BoundType GetBound( void ) const
+	{
+		return( (BoundType)( ( m_nData >> 40 ) & 0x03 ) );
+	}
+
+	inline int GetGeneration( void ) const
+	{
+		return( (int)( m_nData >> 42 ) & cnGenerationMask );
+	}
+}; // class CTranspositionTableEntry
+
+
+// The table is shared by the search threads without locks.  A slot holds
+// the key XORed with the data, so a slot torn by two threads writing to it
+// at the same time fails the key check instead of returning wrong data.
+
+class CTranspositionTableSlot
+{
+public:
+	atomic<unsigned long long> m_nKeyXorData;
+	atomic<unsigned long long> m_nData;
+}; // class CTranspositionTableSlot
+
+
+static const int cnEntriesPerBucket = cnCacheLineSize / sizeof( CTranspositionTableSlot );
+
+
+class CTranspositionTableBucket
+{
+public:
+	CTranspositionTableSlot m_aSlots[cnEntriesPerBucket];
+}; // class CTranspositionTableBucket
+
+
+class CTranspositionTable
+{
+private:
+	unsigned char * m_pAllocation;
+	CTranspositionTableBucket * m_pBuckets;		// Aligned to a cache line.
+	unsigned long long m_nNumBuckets;			// A power of two.
+	int m_nGeneration;
+
+	// Private copy constructor and assignment operator; ie. disallow copying.
+	CTranspositionTable( const CTranspositionTable & Src );
+	CTranspositionTable & operator=( const CTranspositionTable & Src );
+
+	inline CTranspositionTableBucket & GetBucket( HashKeyType nKey ) const
+	{
+		return( m_pBuckets[nKey & ( m_nNumBuckets - 1 )] );
+	}
+
+public:
+	explicit CTranspositionTable( int nSizeInMB = cnDefaultTranspositionTableSizeInMB ) throw( CException );
+	~CTranspositionTable( void );
+
+	void Resize( int nSizeInMB ) throw( CException );
+	void Clear( void );
+	void NewSearch( void );
+	bool Probe( HashKeyType nKey, CTranspositionTableEntry & entry ) const;
+	void Store( HashKeyType nKey, ScoreType nScore, const CMove & bestMove, int nDepth, BoundType Bound );
+}; // class CTranspositionTable
+
+
+CTranspositionTable::CTranspositionTable( int nSizeInMB ) throw( CException )
+	: m_pAllocation( 0 ),
+		m_pBuckets( 0 ),
+		m_nNumBuckets( 0 ),
+		m_nGeneration( 0 )
+{
+	Resize( nSizeInMB );
+}
+
+
+CTranspositionTable::~CTranspositionTable( void )
+{
+	delete [] m_pAllocation;
+	m_pAllocation = 0;
+	m_pBuckets = 0;
+}
+
+
+void CTranspositionTable::Resize( int nSizeInMB ) throw( CException )
+{
+
+	if( nSizeInMB <= 0 )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	// Use the largest power-of-two number of buckets that fits in the requested size.
+	const unsigned long long knMaxNumBuckets = ( (unsigned long long)nSizeInMB << 20 ) / sizeof( CTranspositionTableBucket );
+	unsigned long long nNumBuckets = 1;
+
+	while( nNumBuckets * 2 <= knMaxNumBuckets )
+	{
+		nNumBuckets *= 2;
+	}
+
+	delete [] m_pAllocation;
+	m_pAllocation = 0;
+	m_pBuckets = 0;
+	m_nNumBuckets = 0;
+
+	try
+	{
+		m_pAllocation = new unsigned char[nNumBuckets * sizeof( CTranspositionTableBucket ) + cnCacheLineSize];
+	}
+	catch( ... )
+	{
+	}
+
+	if( m_pAllocation == 0 )
+	{
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+
+	// Align the buckets to a cache line, so that probing a bucket touches only one line.
+	const size_t knMisalignment = (size_t)m_pAllocation % cnCacheLineSize;
+
+	m_pBuckets = (CTranspositionTableBucket *)( m_pAllocation + ( knMisalignment == 0 ? 0 : cnCacheLineSize - knMisalignment ) );
+	m_nNumBuckets = nNumBuckets;
+	Clear();
+}
+
+
+void CTranspositionTable::Clear( void )
+{
+
+	for( unsigned long long i = 0; i < m_nNumBuckets; ++i )
+	{
+
+		for( int j = 0; j < cnEntriesPerBucket; ++j )
+		{
+			m_pBuckets[i].m_aSlots[j].m_nKeyXorData.store( 0, memory_order_relaxed );
+			m_pBuckets[i].m_aSlots[j].m_nData.store( 0, memory_order_relaxed );
+		}
+	}
+
+	m_nGeneration = 0;
+}
+
+
+void CTranspositionTable::NewSearch( void )
+{
+	// Entries from earlier searches are replaced first.
+	m_nGeneration = ( m_nGeneration + 1 ) & cnGenerationMask;
+}
+
+
+bool CTranspositionTable::Probe( HashKeyType nKey, CTranspositionTableEntry & entry ) const
+{
+	const CTranspositionTableBucket & kBucket = GetBucket( nKey );
+
+	for( int i = 0; i < cnEntriesPerBucket; ++i )
+	{
+		entry.m_nData = kBucket.m_aSlots[i].m_nData.load( memory_order_relaxed );
+		entry.m_nKey = kBucket.m_aSlots[i].m_nKeyXorData.load( memory_order_relaxed ) ^ entry.m_nData;
+
+		if( entry.m_nKey == nKey  &&  entry.GetBound() != eBoundType_None )
+		{
+			return( true );
+		}
+	}
+
+	return( false );
+}
+
+
+void CTranspositionTable::Store( HashKeyType nKey, ScoreType nScore, const CMove & bestMove, int nDepth, BoundType Bound )
+{
+	// Overwrite the entry for this key if there is one; otherwise replace
+	// the entry that is least worth keeping: empty, from an older search,
+	// or searched to the shallowest depth.
+	CTranspositionTableBucket & bucket = GetBucket( nKey );
+	CTranspositionTableSlot * pReplace = &bucket.m_aSlots[0];
+	int nLowestWorth = 0x7FFFFFFF;
+
+	for( int i = 0; i < cnEntriesPerBucket; ++i )
+	{
+		CTranspositionTableSlot & slot = bucket.m_aSlots[i];
+		CTranspositionTableEntry entry;
+
+		entry.m_nData = slot.m_nData.load( memory_order_relaxed );
+		entry.m_nKey = slot.m_nKeyXorData.load( memory_order_relaxed ) ^ entry.m_nData;
+
+		if( entry.m_nKey == nKey  ||  entry.GetBound() == eBoundType_None )
+		{
+			pReplace = &slot;
+			break;
+		}
+
+		const int knAge = ( m_nGeneration - entry.GetGeneration() ) & cnGenerationMask;
+		const int knWorth = entry.GetDepth() - 8 * knAge;
+
+		if( knWorth < nLowestWorth )
+		{
+			nLowestWorth = knWorth;
+			pReplace = &slot;
+		}
+	}
+
+	const unsigned long long knData = CTranspositionTableEntry::PackData( nScore, bestMove, nDepth, Bound, m_nGeneration );
+
+	pReplace->m_nKeyXorData.store( nKey ^ knData, memory_order_relaxed );
+	pReplace->m_nData.store( knData, memory_order_relaxed );
+}
+
+
+// **** Castling Rights ****
+
+// The castling rights are the bits of CGame::m_nCastlingRights.
+
+enum CastlingRightsType
+{
+	eCastlingRights_WhiteKingside = 1,
+	eCastlingRights_WhiteQueenside = 2,
+	eCastlingRights_BlackKingside = 4,
+	eCastlingRights_BlackQueenside = 8,
+	eCastlingRights_All = 15
+};
+
+
+static inline int GetCastlingRight( int nPlayerID, bool bKingside )
+{
+	return( 1 << ( 2 * nPlayerID + ( bKingside ? 0 : 1 ) ) );
+}
+
+
+// The castling rights that survive a move from or to each square:
+// moving a king or a rook, or capturing a rook, gives up those rights.
+
+static const int canCastlingRightsMasks[cnBoardArea] =
+{
+	13, 15, 15, 15, 12, 15, 15, 14,		// a1, e1 and h1.
+	15, 15, 15, 15, 15, 15, 15, 15,
+	15, 15, 15, 15, 15, 15, 15, 15,
+	15, 15, 15, 15, 15, 15, 15, 15,
+	15, 15, 15, 15, 15, 15, 15, 15,
+	15, 15, 15, 15, 15, 15, 15, 15,
+	15, 15, 15, 15, 15, 15, 15, 15,
+	 7, 15, 15, 15,  3, 15, 15, 11		// a8, e8 and h8.
+};
+
+
+// **** Class CUndoRecord ****
+
+// Everything that CGame::UnmakeMove() needs to take back a move.
+
+class CUndoRecord
+{
+public:
+	HashKeyType m_nHashKey;
+	CMove m_Move;
+	unsigned char m_MovingPieceType;		// A PieceTypeType; a pawn, if the move promotes.
+	unsigned char m_CapturedPieceType;		// ePieceType_Null if nothing was captured.
+	unsigned char m_nCastlingRights;
+	signed char m_nPawnCapturableViaEnPassant;
+	unsigned short m_nHalfMoveClock;
+}; // class CUndoRecord
+
+
+// Enough for the longest games, plus the search.
+static const int cnMaxNumUndoRecords = 1024;
+
+
+// **** Class CRandomNumberGenerator ****
+
+// A small, fast pseudo-random number generator (xorshift64*).  Each game,
+// and so each search thread, has its own, so that the threads share no state;
+// seeding it with the same value makes a single-threaded search repeatable.
+
+class CRandomNumberGenerator
+{
+private:
+	unsigned long long m_nState;		// Never zero.
+
+public:
+	explicit CRandomNumberGenerator( unsigned long long nSeed )
+	{
+		Seed( nSeed );
+	}
+
+	void Seed( unsigned long long nSeed )
+	{
+		// Scramble the seed (SplitMix64), so that similar seeds give unrelated sequences.
+		nSeed += 0x9E3779B97F4A7C15ULL;
+		nSeed = ( nSeed ^ ( nSeed >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+		nSeed = ( nSeed ^ ( nSeed >> 27 ) ) * 0x94D049BB133111EBULL;
+		nSeed ^= nSeed >> 31;
+		m_nState = nSeed != 0 ? nSeed : 0x9E3779B97F4A7C15ULL;
+	}
+
+	inline unsigned long long GetNext( void )
+	{
+		m_nState ^= m_nState >> 12;
+		m_nState ^= m_nState << 25;
+		m_nState ^= m_nState >> 27;
+		return( m_nState * 0x2545F4914F6CDD1DULL );
+	}
+
+	inline int GetNextBelow( int nLimit )
+	{
+		// A number from 0 to nLimit - 1.
+		return( (int)( GetNext() % (unsigned long long)nLimit ) );
+	}
+}; // class CRandomNumberGenerator
+
+
+// **** Class CMemoryMappedFile ****
+
+// A read-only view of a file's contents.  The file is mapped rather than
+// read, so the operating system pages in only the parts that are touched.
+
+class CMemoryMappedFile
+{
+private:
+	const unsigned char * m_pcData;
+	size_t m_nSize;
+#if defined( _WIN32 )
+	HANDLE m_hFileMapping;
+#endif
+
+	// Private copy constructor and assignment operator; ie. disallow copying.
+	CMemoryMappedFile( const CMemoryMappedFile & Src );
+	CMemoryMappedFile & operator=( const CMemoryMappedFile & Src );
+
+public:
+	CMemoryMappedFile( void );
+	~CMemoryMappedFile( void );
+
+	void Open( const char * pcPath ) throw( CException );
+	void Close( void );
+
+	inline bool IsOpen( void ) const
+	{
+		return( m_pcData != 0 );
+	}
+
+	inline const unsigned char * GetData( void ) const
+	{
+		return( m_pcData );
+	}
+
+	inline size_t GetSize( void ) const
+	{
+		return( m_nSize );
+	}
+}; // class CMemoryMappedFile
+
+
+CMemoryMappedFile::CMemoryMappedFile( void )
+	: m_pcData( 0 ),
+		m_nSize( 0 )
+#if defined( _WIN32 )
+		, m_hFileMapping( 0 )
+#endif
+{
+}
+
+
+CMemoryMappedFile::~CMemoryMappedFile( void )
+{
+	Close();
+}
+
+
+void CMemoryMappedFile::Open( const char * pcPath ) throw( CException )
+{
+	// An empty file can't be mapped, and is rejected.
+	Close();
+
+#if defined( _WIN32 )
+	const HANDLE khFile = CreateFileA( pcPath, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+	LARGE_INTEGER nFileSize;
+
+	if( khFile == INVALID_HANDLE_VALUE )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	if( !GetFileSizeEx( khFile, &nFileSize )  ||  nFileSize.QuadPart == 0 )
+	{
+		CloseHandle( khFile );
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	m_hFileMapping = CreateFileMappingA( khFile, 0, PAGE_READONLY, 0, 0, 0 );
+	CloseHandle( khFile );			// The mapping keeps the file open.
+
+	if( m_hFileMapping != 0 )
+	{
+		m_pcData = (const unsigned char *)MapViewOfFile( m_hFileMapping, FILE_MAP_READ, 0, 0, 0 );
+	}
+
+	if( m_pcData == 0 )
+	{
+		Close();
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+
+	m_nSize = (size_t)nFileSize.QuadPart;
+#else
+	const int knFile = open( pcPath, O_RDONLY );
+	struct stat fileStatus;
+
+	if( knFile < 0 )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	if( fstat( knFile, &fileStatus ) != 0  ||  fileStatus.st_size == 0 )
+	{
+		close( knFile );
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	void * pMapping = mmap( 0, (size_t)fileStatus.st_size, PROT_READ, MAP_SHARED, knFile, 0 );
+
+	close( knFile );				// The mapping keeps the file open.
+
+	if( pMapping == MAP_FAILED )
+	{
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+
+	m_pcData = (const unsigned char *)pMapping;
+	m_nSize = (size_t)fileStatus.st_size;
+#endif
+}
+
+
+void CMemoryMappedFile::Close( void )
+{
+
+#if defined( _WIN32 )
+	if( m_pcData != 0 )
+	{
+		UnmapViewOfFile( m_pcData );
+	}
+
+	if( m_hFileMapping != 0 )
+	{
+		CloseHandle( m_hFileMapping );
+		m_hFileMapping = 0;
+	}
+#else
+	if( m_pcData != 0 )
+	{
+		munmap( (void *)m_pcData, m_nSize );
+	}
+#endif
+
+	m_pcData = 0;
+	m_nSize = 0;
+}
+
+
+// **** Class CPositionFileReader ****
+
+// Reads the positions in a FEN or EPD file, one to a line, through a memory
+// mapping.  Each line is copied into a fixed buffer and terminated there, so
+// that nothing is allocated per line; blank lines and comments (lines that
+// begin with '#') are skipped.
+
+static const size_t cnMaxPositionLineLength = 1023;		// Longer lines are reported, and not returned whole.
+
+
+class CPositionFileReader
+{
+private:
+	CMemoryMappedFile m_File;
+	size_t m_nOffset;
+	char m_acLine[cnMaxPositionLineLength + 1];
+
+public:
+	explicit CPositionFileReader( const char * pcPath ) throw( CException )
+		: m_nOffset( 0 )
+	{
+		m_File.Open( pcPath );
+	}
+
+	const char * ReadLine( bool & bIsTooLong );
+}; // class CPositionFileReader
+
+
+const char * CPositionFileReader::ReadLine( bool & bIsTooLong )
+{
+	// Returns the next line, without its line break, or 0 at the end of the file.
+	// The line is valid until the next call.  If the line is longer than the
+	// buffer, bIsTooLong is set and only the beginning of the line is returned,
+	// for the caller to report.
+	const char * const kpcData = (const char *)m_File.GetData();
+	const size_t knSize = m_File.GetSize();
+
+	while( m_nOffset < knSize )
+	{
+		const char * const kpcLine = kpcData + m_nOffset;
+		const char * const kpcLineBreak = (const char *)memchr( kpcLine, '\n', knSize - m_nOffset );
+		const size_t knLineLength = ( kpcLineBreak != 0 ? kpcLineBreak : kpcData + knSize ) - kpcLine;
+		size_t nLength = min( knLineLength, cnMaxPositionLineLength );
+
+		m_nOffset += knLineLength + 1;
+		bIsTooLong = false;
+
+		while( nLength > 0  &&  ( kpcLine[nLength - 1] == '\r'  ||  kpcLine[nLength - 1] == ' '  ||  kpcLine[nLength - 1] == '\t' ) )
+		{
+			--nLength;
+		}
+
+		if( nLength == 0  ||  kpcLine[0] == '#' )
+		{
+			continue;
+		}
+
+		memcpy( m_acLine, kpcLine, nLength );
+		m_acLine[nLength] = '\0';
+
+		if( knLineLength > cnMaxPositionLineLength )
+		{
+			// Trailing white space doesn't count.
+			const char * pcEnd = kpcLine + knLineLength;
+
+			while( pcEnd > kpcLine + cnMaxPositionLineLength  &&
+				( pcEnd[-1] == '\r'  ||  pcEnd[-1] == ' '  ||  pcEnd[-1] == '\t' ) )
+			{
+				--pcEnd;
+			}
+
+			bIsTooLong = pcEnd > kpcLine + cnMaxPositionLineLength;
+		}
+
+		return( m_acLine );
+	}
+
+	return( 0 );
+}
+
+
+// **** Class COpeningBook ****
+
+// An opening book in the Polyglot .bin format: 16-byte big-endian entries,
+// sorted by key, each holding a key, a move, a weight and a learning value.
+// The keys are Polyglot's, not pdchess2's own Zobrist keys; see CGame::ComputePolyglotKey().
+
+static const size_t cnBookEntrySize = 16;
+
+// Polyglot's random numbers, from which the book keys are made: 768 for the pieces,
+// indexed by 64 * kind + square, where the kinds are the black pawn, the white pawn,
+// the black knight, ..., the white king; then 4 for the castling rights (White's
+// kingside and queenside, then Black's), 8 for the column of an en passant capture,
+// and 1 for White to move.
+
+static const int cnPolyglotCastlingOffset = 768;
+static const int cnPolyglotEnPassantOffset = 772;
+static const int cnPolyglotWhiteToMoveOffset = 780;
+
+static const HashKeyType canPolyglotRandom64[781] =
+{
+	0x9D39247E33776D41ULL, 0x2AF7398005AAA5C7ULL, 0x44DB015024623547ULL, 0x9C15F73E62A76AE2ULL,
+	0x75834465489C0C89ULL, 0x3290AC3A203001BFULL, 0x0FBBAD1F61042279ULL, 0xE83A908FF2FB60CAULL,
+	0x0D7E765D58755C10ULL, 0x1A083822CEAFE02DULL, 0x9605D5F0E25EC3B0ULL, 0xD021FF5CD13A2ED5ULL,
+	0x40BDF15D4A672E32ULL, 0x011355146FD56395ULL, 0x5DB4832046F3D9E5ULL, 0x239F8B2D7FF719CCULL,
+	0x05D1A1AE85B49AA1ULL, 0x679F848F6E8FC971ULL, 0x7449BBFF801FED0BULL, 0x7D11CDB1C3B7ADF0ULL,
+	0x82C7709E781EB7CCULL, 0xF3218F1C9510786CULL, 0x331478F3AF51BBE6ULL, 0x4BB38DE5E7219443ULL,
+	0xAA649C6EBCFD50FCULL, 0x8DBD98A352AFD40BULL, 0x87D2074B81D79217ULL, 0x19F3C751D3E92AE1ULL,
+	0xB4AB30F062B19ABFULL, 0x7B0500AC42047AC4ULL, 0xC9452CA81A09D85DULL, 0x24AA6C514DA27500ULL,
+	0x4C9F34427501B447ULL, 0x14A68FD73C910841ULL, 0xA71B9B83461CBD93ULL, 0x03488B95B0F1850FULL,
+	0x637B2B34FF93C040ULL, 0x09D1BC9A3DD90A94ULL, 0x3575668334A1DD3BULL, 0x735E2B97A4C45A23ULL,
+	0x18727070F1BD400BULL, 0x1FCBACD259BF02E7ULL, 0xD310A7C2CE9B6555ULL, 0xBF983FE0FE5D8244ULL,
+	0x9F74D14F7454A824ULL, 0x51EBDC4AB9BA3035ULL, 0x5C82C505DB9AB0FAULL, 0xFCF7FE8A3430B241ULL,
+	0x3253A729B9BA3DDEULL, 0x8C74C368081B3075ULL, 0xB9BC6C87167C33E7ULL, 0x7EF48F2B83024E20ULL,
+	0x11D505D4C351BD7FULL, 0x6568FCA92C76A243ULL, 0x4DE0B0F40F32A7B8ULL, 0x96D693460CC37E5DULL,
+	0x42E240CB63689F2FULL, 0x6D2BDCDAE2919661ULL, 0x42880B0236E4D951ULL, 0x5F0F4A5898171BB6ULL,
+	0x39F890F579F92F88ULL, 0x93C5B5F47356388BULL, 0x63DC359D8D231B78ULL, 0xEC16CA8AEA98AD76ULL,
+	0x5355F900C2A82DC7ULL, 0x07FB9F855A997142ULL, 0x5093417AA8A7ED5EULL, 0x7BCBC38DA25A7F3CULL,
+	0x19FC8A768CF4B6D4ULL, 0x637A7780DECFC0D9ULL, 0x8249A47AEE0E41F7ULL, 0x79AD695501E7D1E8ULL,
+	0x14ACBAF4777D5776ULL, 0xF145B6BECCDEA195ULL, 0xDABF2AC8201752FCULL, 0x24C3C94DF9C8D3F6ULL,
+	0xBB6E2924F03912EAULL, 0x0CE26C0B95C980D9ULL, 0xA49CD132BFBF7CC4ULL, 0xE99D662AF4243939ULL,
+	0x27E6AD7891165C3FULL, 0x8535F040B9744FF1ULL, 0x54B3F4FA5F40D873ULL, 0x72B12C32127FED2BULL,
+	0xEE954D3C7B411F47ULL, 0x9A85AC909A24EAA1ULL, 0x70AC4CD9F04F21F5ULL, 0xF9B89D3E99A075C2ULL,
+	0x87B3E2B2B5C907B1ULL, 0xA366E5B8C54F48B8ULL, 0xAE4A9346CC3F7CF2ULL, 0x1920C04D47267BBDULL,
+	0x87BF02C6B49E2AE9ULL, 0x092237AC237F3859ULL, 0xFF07F64EF8ED14D0ULL, 0x8DE8DCA9F03CC54EULL,
+	0x9C1633264DB49C89ULL, 0xB3F22C3D0B0B38EDULL, 0x390E5FB44D01144BULL, 0x5BFEA5B4712768E9ULL,
+	0x1E1032911FA78984ULL, 0x9A74ACB964E78CB3ULL, 0x4F80F7A035DAFB04ULL, 0x6304D09A0B3738C4ULL,
+	0x2171E64683023A08ULL, 0x5B9B63EB9CEFF80CULL, 0x506AACF489889342ULL, 0x1881AFC9A3A701D6ULL,
+	0x6503080440750644ULL, 0xDFD395339CDBF4A7ULL, 0xEF927DBCF00C20F2ULL, 0x7B32F7D1E03680ECULL,
+	0xB9FD7620E7316243ULL, 0x05A7E8A57DB91B77ULL, 0xB5889C6E15630A75ULL, 0x4A750A09CE9573F7ULL,
+	0xCF464CEC899A2F8AULL, 0xF538639CE705B824ULL, 0x3C79A0FF5580EF7FULL, 0xEDE6C87F8477609DULL,
+	0x799E81F05BC93F31ULL, 0x86536B8CF3428A8CULL, 0x97D7374C60087B73ULL, 0xA246637CFF328532ULL,
+	0x043FCAE60CC0EBA0ULL, 0x920E449535DD359EULL, 0x70EB093B15B290CCULL, 0x73A1921916591CBDULL,
+	0x56436C9FE1A1AA8DULL, 0xEFAC4B70633B8F81ULL, 0xBB215798D45DF7AFULL, 0x45F20042F24F1768ULL,
+	0x930F80F4E8EB7462ULL, 0xFF6712FFCFD75EA1ULL, 0xAE623FD67468AA70ULL, 0xDD2C5BC84BC8D8FCULL,
+	0x7EED120D54CF2DD9ULL, 0x22FE545401165F1CULL, 0xC91800E98FB99929ULL, 0x808BD68E6AC10365ULL,
+	0xDEC468145B7605F6ULL, 0x1BEDE3A3AEF53302ULL, 0x43539603D6C55602ULL, 0xAA969B5C691CCB7AULL,
+	0xA87832D392EFEE56ULL, 0x65942C7B3C7E11AEULL, 0xDED2D633CAD004F6ULL, 0x21F08570F420E565ULL,
+	0xB415938D7DA94E3CULL, 0x91B859E59ECB6350ULL, 0x10CFF333E0ED804AULL, 0x28AED140BE0BB7DDULL,
+	0xC5CC1D89724FA456ULL, 0x5648F680F11A2741ULL, 0x2D255069F0B7DAB3ULL, 0x9BC5A38EF729ABD4ULL,
+	0xEF2F054308F6A2BCULL, 0xAF2042F5CC5C2858ULL, 0x480412BAB7F5BE2AULL, 0xAEF3AF4A563DFE43ULL,
+	0x19AFE59AE451497FULL, 0x52593803DFF1E840ULL, 0xF4F076E65F2CE6F0ULL, 0x11379625747D5AF3ULL,
+	0xBCE5D2248682C115ULL, 0x9DA4243DE836994FULL, 0x066F70B33FE09017ULL, 0x4DC4DE189B671A1CULL,
+	0x51039AB7712457C3ULL, 0xC07A3F80C31FB4B4ULL, 0xB46EE9C5E64A6E7CULL, 0xB3819A42ABE61C87ULL,
+	0x21A007933A522A20ULL, 0x2DF16F761598AA4FULL, 0x763C4A1371B368FDULL, 0xF793C46702E086A0ULL,
+	0xD7288E012AEB8D31ULL, 0xDE336A2A4BC1C44BULL, 0x0BF692B38D079F23ULL, 0x2C604A7A177326B3ULL,
+	0x4850E73E03EB6064ULL, 0xCFC447F1E53C8E1BULL, 0xB05CA3F564268D99ULL, 0x9AE182C8BC9474E8ULL,
+	0xA4FC4BD4FC5558CAULL, 0xE755178D58FC4E76ULL, 0x69B97DB1A4C03DFEULL, 0xF9B5B7C4ACC67C96ULL,
+	0xFC6A82D64B8655FBULL, 0x9C684CB6C4D24417ULL, 0x8EC97D2917456ED0ULL, 0x6703DF9D2924E97EULL,
+	0xC547F57E42A7444EULL, 0x78E37644E7CAD29EULL, 0xFE9A44E9362F05FAULL, 0x08BD35CC38336615ULL,
+	0x9315E5EB3A129ACEULL, 0x94061B871E04DF75ULL, 0xDF1D9F9D784BA010ULL, 0x3BBA57B68871B59DULL,
+	0xD2B7ADEEDED1F73FULL, 0xF7A255D83BC373F8ULL, 0xD7F4F2448C0CEB81ULL, 0xD95BE88CD210FFA7ULL,
+	0x336F52F8FF4728E7ULL, 0xA74049DAC312AC71ULL, 0xA2F61BB6E437FDB5ULL, 0x4F2A5CB07F6A35B3ULL,
+	0x87D380BDA5BF7859ULL, 0x16B9F7E06C453A21ULL, 0x7BA2484C8A0FD54EULL, 0xF3A678CAD9A2E38CULL,
+	0x39B0BF7DDE437BA2ULL, 0xFCAF55C1BF8A4424ULL, 0x18FCF680573FA594ULL, 0x4C0563B89F495AC3ULL,
+	0x40E087931A00930DULL, 0x8CFFA9412EB642C1ULL, 0x68CA39053261169FULL, 0x7A1EE967D27579E2ULL,
+	0x9D1D60E5076F5B6FULL, 0x3810E399B6F65BA2ULL, 0x32095B6D4AB5F9B1ULL, 0x35CAB62109DD038AULL,
+	0xA90B24499FCFAFB1ULL, 0x77A225A07CC2C6BDULL, 0x513E5E634C70E331ULL, 0x4361C0CA3F692F12ULL,
+	0xD941ACA44B20A45BULL, 0x528F7C8602C5807BULL, 0x52AB92BEB9613989ULL, 0x9D1DFA2EFC557F73ULL,
+	0x722FF175F572C348ULL, 0x1D1260A51107FE97ULL, 0x7A249A57EC0C9BA2ULL, 0x04208FE9E8F7F2D6ULL,
+	0x5A110C6058B920A0ULL, 0x0CD9A497658A5698ULL, 0x56FD23C8F9715A4CULL, 0x284C847B9D887AAEULL,
+	0x04FEABFBBDB619CBULL, 0x742E1E651C60BA83ULL, 0x9A9632E65904AD3CULL, 0x881B82A13B51B9E2ULL,
+	0x506E6744CD974924ULL, 0xB0183DB56FFC6A79ULL, 0x0ED9B915C66ED37EULL, 0x5E11E86D5873D484ULL,
+	0xF678647E3519AC6EULL, 0x1B85D488D0F20CC5ULL, 0xDAB9FE6525D89021ULL, 0x0D151D86ADB73615ULL,
+	0xA865A54EDCC0F019ULL, 0x93C42566AEF98FFBULL, 0x99E7AFEABE000731ULL, 0x48CBFF086DDF285AULL,
+	0x7F9B6AF1EBF78BAFULL, 0x58627E1A149BBA21ULL, 0x2CD16E2ABD791E33ULL, 0xD363EFF5F0977996ULL,
+	0x0CE2A38C344A6EEDULL, 0x1A804AADB9CFA741ULL, 0x907F30421D78C5DEULL, 0x501F65EDB3034D07ULL,
+	0x37624AE5A48FA6E9ULL, 0x957BAF61700CFF4EULL, 0x3A6C27934E31188AULL, 0xD49503536ABCA345ULL,
+	0x088E049589C432E0ULL, 0xF943AEE7FEBF21B8ULL, 0x6C3B8E3E336139D3ULL, 0x364F6FFA464EE52EULL,
+	0xD60F6DCEDC314222ULL, 0x56963B0DCA418FC0ULL, 0x16F50EDF91E513AFULL, 0xEF1955914B609F93ULL,
+	0x565601C0364E3228ULL, 0xECB53939887E8175ULL, 0xBAC7A9A18531294BULL, 0xB344C470397BBA52ULL,
+	0x65D34954DAF3CEBDULL, 0xB4B81B3FA97511E2ULL, 0xB422061193D6F6A7ULL, 0x071582401C38434DULL,
+	0x7A13F18BBEDC4FF5ULL, 0xBC4097B116C524D2ULL, 0x59B97885E2F2EA28ULL, 0x99170A5DC3115544ULL,
+	0x6F423357E7C6A9F9ULL, 0x325928EE6E6F8794ULL, 0xD0E4366228B03343ULL, 0x565C31F7DE89EA27ULL,
+	0x30F5611484119414ULL, 0xD873DB391292ED4FULL, 0x7BD94E1D8E17DEBCULL, 0xC7D9F16864A76E94ULL,
+	0x947AE053EE56E63CULL, 0xC8C93882F9475F5FULL, 0x3A9BF55BA91F81CAULL, 0xD9A11FBB3D9808E4ULL,
+	0x0FD22063EDC29FCAULL, 0xB3F256D8ACA0B0B9ULL, 0xB03031A8B4516E84ULL, 0x35DD37D5871448AFULL,
+	0xE9F6082B05542E4EULL, 0xEBFAFA33D7254B59ULL, 0x9255ABB50D532280ULL, 0xB9AB4CE57F2D34F3ULL,
+	0x693501D628297551ULL, 0xC62C58F97DD949BFULL, 0xCD454F8F19C5126AULL, 0xBBE83F4ECC2BDECBULL,
+	0xDC842B7E2819E230ULL, 0xBA89142E007503B8ULL, 0xA3BC941D0A5061CBULL, 0xE9F6760E32CD8021ULL,
+	0x09C7E552BC76492FULL, 0x852F54934DA55CC9ULL, 0x8107FCCF064FCF56ULL, 0x098954D51FFF6580ULL,
+	0x23B70EDB1955C4BFULL, 0xC330DE426430F69DULL, 0x4715ED43E8A45C0AULL, 0xA8D7E4DAB780A08DULL,
+	0x0572B974F03CE0BBULL, 0xB57D2E985E1419C7ULL, 0xE8D9ECBE2CF3D73FULL, 0x2FE4B17170E59750ULL,
+	0x11317BA87905E790ULL, 0x7FBF21EC8A1F45ECULL, 0x1725CABFCB045B00ULL, 0x964E915CD5E2B207ULL,
+	0x3E2B8BCBF016D66DULL, 0xBE7444E39328A0ACULL, 0xF85B2B4FBCDE44B7ULL, 0x49353FEA39BA63B1ULL,
+	0x1DD01AAFCD53486AULL, 0x1FCA8A92FD719F85ULL, 0xFC7C95D827357AFAULL, 0x18A6A990C8B35EBDULL,
+	0xCCCB7005C6B9C28DULL, 0x3BDBB92C43B17F26ULL, 0xAA70B5B4F89695A2ULL, 0xE94C39A54A98307FULL,
+	0xB7A0B174CFF6F36EULL, 0xD4DBA84729AF48ADULL, 0x2E18BC1AD9704A68ULL, 0x2DE0966DAF2F8B1CULL,
+	0xB9C11D5B1E43A07EULL, 0x64972D68DEE33360ULL, 0x94628D38D0C20584ULL, 0xDBC0D2B6AB90A559ULL,
+	0xD2733C4335C6A72FULL, 0x7E75D99D94A70F4DULL, 0x6CED1983376FA72BULL, 0x97FCAACBF030BC24ULL,
+	0x7B77497B32503B12ULL, 0x8547EDDFB81CCB94ULL, 0x79999CDFF70902CBULL, 0xCFFE1939438E9B24ULL,
+	0x829626E3892D95D7ULL, 0x92FAE24291F2B3F1ULL, 0x63E22C147B9C3403ULL, 0xC678B6D860284A1CULL,
+	0x5873888850659AE7ULL, 0x0981DCD296A8736DULL, 0x9F65789A6509A440ULL, 0x9FF38FED72E9052FULL,
+	0xE479EE5B9930578CULL, 0xE7F28ECD2D49EECDULL, 0x56C074A581EA17FEULL, 0x5544F7D774B14AEFULL,
+	0x7B3F0195FC6F290FULL, 0x12153635B2C0CF57ULL, 0x7F5126DBBA5E0CA7ULL, 0x7A76956C3EAFB413ULL,
+	0x3D5774A11D31AB39ULL, 0x8A1B083821F40CB4ULL, 0x7B4A38E32537DF62ULL, 0x950113646D1D6E03ULL,
+	0x4DA8979A0041E8A9ULL, 0x3BC36E078F7515D7ULL, 0x5D0A12F27AD310D1ULL, 0x7F9D1A2E1EBE1327ULL,
+	0xDA3A361B1C5157B1ULL, 0xDCDD7D20903D0C25ULL, 0x36833336D068F707ULL, 0xCE68341F79893389ULL,
+	0xAB9090168DD05F34ULL, 0x43954B3252DC25E5ULL, 0xB438C2B67F98E5E9ULL, 0x10DCD78E3851A492ULL,
+	0xDBC27AB5447822BFULL, 0x9B3CDB65F82CA382ULL, 0xB67B7896167B4C84ULL, 0xBFCED1B0048EAC50ULL,
+	0xA9119B60369FFEBDULL, 0x1FFF7AC80904BF45ULL, 0xAC12FB171817EEE7ULL, 0xAF08DA9177DDA93DULL,
+	0x1B0CAB936E65C744ULL, 0xB559EB1D04E5E932ULL, 0xC37B45B3F8D6F2BAULL, 0xC3A9DC228CAAC9E9ULL,
+	0xF3B8B6675A6507FFULL, 0x9FC477DE4ED681DAULL, 0x67378D8ECCEF96CBULL, 0x6DD856D94D259236ULL,
+	0xA319CE15B0B4DB31ULL, 0x073973751F12DD5EULL, 0x8A8E849EB32781A5ULL, 0xE1925C71285279F5ULL,
+	0x74C04BF1790C0EFEULL, 0x4DDA48153C94938AULL, 0x9D266D6A1CC0542CULL, 0x7440FB816508C4FEULL,
+	0x13328503DF48229FULL, 0xD6BF7BAEE43CAC40ULL, 0x4838D65F6EF6748FULL, 0x1E152328F3318DEAULL,
+	0x8F8419A348F296BFULL, 0x72C8834A5957B511ULL, 0xD7A023A73260B45CULL, 0x94EBC8ABCFB56DAEULL,
+	0x9FC10D0F989993E0ULL, 0xDE68A2355B93CAE6ULL, 0xA44CFE79AE538BBEULL, 0x9D1D84FCCE371425ULL,
+	0x51D2B1AB2DDFB636ULL, 0x2FD7E4B9E72CD38CULL, 0x65CA5B96B7552210ULL, 0xDD69A0D8AB3B546DULL,
+	0x604D51B25FBF70E2ULL, 0x73AA8A564FB7AC9EULL, 0x1A8C1E992B941148ULL, 0xAAC40A2703D9BEA0ULL,
+	0x764DBEAE7FA4F3A6ULL, 0x1E99B96E70A9BE8BULL, 0x2C5E9DEB57EF4743ULL, 0x3A938FEE32D29981ULL,
+	0x26E6DB8FFDF5ADFEULL, 0x469356C504EC9F9DULL, 0xC8763C5B08D1908CULL, 0x3F6C6AF859D80055ULL,
+	0x7F7CC39420A3A545ULL, 0x9BFB227EBDF4C5CEULL, 0x89039D79D6FC5C5CULL, 0x8FE88B57305E2AB6ULL,
+	0xA09E8C8C35AB96DEULL, 0xFA7E393983325753ULL, 0xD6B6D0ECC617C699ULL, 0xDFEA21EA9E7557E3ULL,
+	0xB67C1FA481680AF8ULL, 0xCA1E3785A9E724E5ULL, 0x1CFC8BED0D681639ULL, 0xD18D8549D140CAEAULL,
+	0x4ED0FE7E9DC91335ULL, 0xE4DBF0634473F5D2ULL, 0x1761F93A44D5AEFEULL, 0x53898E4C3910DA55ULL,
+	0x734DE8181F6EC39AULL, 0x2680B122BAA28D97ULL, 0x298AF231C85BAFABULL, 0x7983EED3740847D5ULL,
+	0x66C1A2A1A60CD889ULL, 0x9E17E49642A3E4C1ULL, 0xEDB454E7BADC0805ULL, 0x50B704CAB602C329ULL,
+	0x4CC317FB9CDDD023ULL, 0x66B4835D9EAFEA22ULL, 0x219B97E26FFC81BDULL, 0x261E4E4C0A333A9DULL,
+	0x1FE2CCA76517DB90ULL, 0xD7504DFA8816EDBBULL, 0xB9571FA04DC089C8ULL, 0x1DDC0325259B27DEULL,
+	0xCF3F4688801EB9AAULL, 0xF4F5D05C10CAB243ULL, 0x38B6525C21A42B0EULL, 0x36F60E2BA4FA6800ULL,
+	0xEB3593803173E0CEULL, 0x9C4CD6257C5A3603ULL, 0xAF0C317D32ADAA8AULL, 0x258E5A80C7204C4BULL,
+	0x8B889D624D44885DULL, 0xF4D14597E660F855ULL, 0xD4347F66EC8941C3ULL, 0xE699ED85B0DFB40DULL,
+	0x2472F6207C2D0484ULL, 0xC2A1E7B5B459AEB5ULL, 0xAB4F6451CC1D45ECULL, 0x63767572AE3D6174ULL,
+	0xA59E0BD101731A28ULL, 0x116D0016CB948F09ULL, 0x2CF9C8CA052F6E9FULL, 0x0B090A7560A968E3ULL,
+	0xABEEDDB2DDE06FF1ULL, 0x58EFC10B06A2068DULL, 0xC6E57A78FBD986E0ULL, 0x2EAB8CA63CE802D7ULL,
+	0x14A195640116F336ULL, 0x7C0828DD624EC390ULL, 0xD74BBE77E6116AC7ULL, 0x804456AF10F5FB53ULL,
+	0xEBE9EA2ADF4321C7ULL, 0x03219A39EE587A30ULL, 0x49787FEF17AF9924ULL, 0xA1E9300CD8520548ULL,
+	0x5B45E522E4B1B4EFULL, 0xB49C3B3995091A36ULL, 0xD4490AD526F14431ULL, 0x12A8F216AF9418C2ULL,
+	0x001F837CC7350524ULL, 0x1877B51E57A764D5ULL, 0xA2853B80F17F58EEULL, 0x993E1DE72D36D310ULL,
+	0xB3598080CE64A656ULL, 0x252F59CF0D9F04BBULL, 0xD23C8E176D113600ULL, 0x1BDA0492E7E4586EULL,
+	0x21E0BD5026C619BFULL, 0x3B097ADAF088F94EULL, 0x8D14DEDB30BE846EULL, 0xF95CFFA23AF5F6F4ULL,
+	0x3871700761B3F743ULL, 0xCA672B91E9E4FA16ULL, 0x64C8E531BFF53B55ULL, 0x241260ED4AD1E87DULL,
+	0x106C09B972D2E822ULL, 0x7FBA195410E5CA30ULL, 0x7884D9BC6CB569D8ULL, 0x0647DFEDCD894A29ULL,
+	0x63573FF03E224774ULL, 0x4FC8E9560F91B123ULL, 0x1DB956E450275779ULL, 0xB8D91274B9E9D4FBULL,
+	0xA2EBEE47E2FBFCE1ULL, 0xD9F1F30CCD97FB09ULL, 0xEFED53D75FD64E6BULL, 0x2E6D02C36017F67FULL,
+	0xA9AA4D20DB084E9BULL, 0xB64BE8D8B25396C1ULL, 0x70CB6AF7C2D5BCF0ULL, 0x98F076A4F7A2322EULL,
+	0xBF84470805E69B5FULL, 0x94C3251F06F90CF3ULL, 0x3E003E616A6591E9ULL, 0xB925A6CD0421AFF3ULL,
+	0x61BDD1307C66E300ULL, 0xBF8D5108E27E0D48ULL, 0x240AB57A8B888B20ULL, 0xFC87614BAF287E07ULL,
+	0xEF02CDD06FFDB432ULL, 0xA1082C0466DF6C0AULL, 0x8215E577001332C8ULL, 0xD39BB9C3A48DB6CFULL,
+	0x2738259634305C14ULL, 0x61CF4F94C97DF93DULL, 0x1B6BACA2AE4E125BULL, 0x758F450C88572E0BULL,
+	0x959F587D507A8359ULL, 0xB063E962E045F54DULL, 0x60E8ED72C0DFF5D1ULL, 0x7B64978555326F9FULL,
+	0xFD080D236DA814BAULL, 0x8C90FD9B083F4558ULL, 0x106F72FE81E2C590ULL, 0x7976033A39F7D952ULL,
+	0xA4EC0132764CA04BULL, 0x733EA705FAE4FA77ULL, 0xB4D8F77BC3E56167ULL, 0x9E21F4F903B33FD9ULL,
+	0x9D765E419FB69F6DULL, 0xD30C088BA61EA5EFULL, 0x5D94337FBFAF7F5BULL, 0x1A4E4822EB4D7A59ULL,
+	0x6FFE73E81B637FB3ULL, 0xDDF957BC36D8B9CAULL, 0x64D0E29EEA8838B3ULL, 0x08DD9BDFD96B9F63ULL,
+	0x087E79E5A57D1D13ULL, 0xE328E230E3E2B3FBULL, 0x1C2559E30F0946BEULL, 0x720BF5F26F4D2EAAULL,
+	0xB0774D261CC609DBULL, 0x443F64EC5A371195ULL, 0x4112CF68649A260EULL, 0xD813F2FAB7F5C5CAULL,
+	0x660D3257380841EEULL, 0x59AC2C7873F910A3ULL, 0xE846963877671A17ULL, 0x93B633ABFA3469F8ULL,
+	0xC0C0F5A60EF4CDCFULL, 0xCAF21ECD4377B28CULL, 0x57277707199B8175ULL, 0x506C11B9D90E8B1DULL,
+	0xD83CC2687A19255FULL, 0x4A29C6465A314CD1ULL, 0xED2DF21216235097ULL, 0xB5635C95FF7296E2ULL,
+	0x22AF003AB672E811ULL, 0x52E762596BF68235ULL, 0x9AEBA33AC6ECC6B0ULL, 0x944F6DE09134DFB6ULL,
+	0x6C47BEC883A7DE39ULL, 0x6AD047C430A12104ULL, 0xA5B1CFDBA0AB4067ULL, 0x7C45D833AFF07862ULL,
+	0x5092EF950A16DA0BULL, 0x9338E69C052B8E7BULL, 0x455A4B4CFE30E3F5ULL, 0x6B02E63195AD0CF8ULL,
+	0x6B17B224BAD6BF27ULL, 0xD1E0CCD25BB9C169ULL, 0xDE0C89A556B9AE70ULL, 0x50065E535A213CF6ULL,
+	0x9C1169FA2777B874ULL, 0x78EDEFD694AF1EEDULL, 0x6DC93D9526A50E68ULL, 0xEE97F453F06791EDULL,
+	0x32AB0EDB696703D3ULL, 0x3A6853C7E70757A7ULL, 0x31865CED6120F37DULL, 0x67FEF95D92607890ULL,
+	0x1F2B1D1F15F6DC9CULL, 0xB69E38A8965C6B65ULL, 0xAA9119FF184CCCF4ULL, 0xF43C732873F24C13ULL,
+	0xFB4A3D794A9A80D2ULL, 0x3550C2321FD6109CULL, 0x371F77E76BB8417EULL, 0x6BFA9AAE5EC05779ULL,
+	0xCD04F3FF001A4778ULL, 0xE3273522064480CAULL, 0x9F91508BFFCFC14AULL, 0x049A7F41061A9E60ULL,
+	0xFCB6BE43A9F2FE9BULL, 0x08DE8A1C7797DA9BULL, 0x8F9887E6078735A1ULL, 0xB5B4071DBFC73A66ULL,
+	0x230E343DFBA08D33ULL, 0x43ED7F5A0FAE657DULL, 0x3A88A0FBBCB05C63ULL, 0x21874B8B4D2DBC4FULL,
+	0x1BDEA12E35F6A8C9ULL, 0x53C065C6C8E63528ULL, 0xE34A1D250E7A8D6BULL, 0xD6B04D3B7651DD7EULL,
+	0x5E90277E7CB39E2DULL, 0x2C046F22062DC67DULL, 0xB10BB459132D0A26ULL, 0x3FA9DDFB67E2F199ULL,
+	0x0E09B88E1914F7AFULL, 0x10E8B35AF3EEAB37ULL, 0x9EEDECA8E272B933ULL, 0xD4C718BC4AE8AE5FULL,
+	0x81536D601170FC20ULL, 0x91B534F885818A06ULL, 0xEC8177F83F900978ULL, 0x190E714FADA5156EULL,
+	0xB592BF39B0364963ULL, 0x89C350C893AE7DC1ULL, 0xAC042E70F8B383F2ULL, 0xB49B52E587A1EE60ULL,
+	0xFB152FE3FF26DA89ULL, 0x3E666E6F69AE2C15ULL, 0x3B544EBE544C19F9ULL, 0xE805A1E290CF2456ULL,
+	0x24B33C9D7ED25117ULL, 0xE74733427B72F0C1ULL, 0x0A804D18B7097475ULL, 0x57E3306D881EDB4FULL,
+	0x4AE7D6A36EB5DBCBULL, 0x2D8D5432157064C8ULL, 0xD1E649DE1E7F268BULL, 0x8A328A1CEDFE552CULL,
+	0x07A3AEC79624C7DAULL, 0x84547DDC3E203C94ULL, 0x990A98FD5071D263ULL, 0x1A4FF12616EEFC89ULL,
+	0xF6F7FD1431714200ULL, 0x30C05B1BA332F41CULL, 0x8D2636B81555A786ULL, 0x46C9FEB55D120902ULL,
+	0xCCEC0A73B49C9921ULL, 0x4E9D2827355FC492ULL, 0x19EBB029435DCB0FULL, 0x4659D2B743848A2CULL,
+	0x963EF2C96B33BE31ULL, 0x74F85198B05A2E7DULL, 0x5A0F544DD2B1FB18ULL, 0x03727073C2E134B1ULL,
+	0xC7F6AA2DE59AEA61ULL, 0x352787BAA0D7C22FULL, 0x9853EAB63B5E0B35ULL, 0xABBDCDD7ED5C0860ULL,
+	0xCF05DAF5AC8D77B0ULL, 0x49CAD48CEBF4A71EULL, 0x7A4C10EC2158C4A6ULL, 0xD9E92AA246BF719EULL,
+	0x13AE978D09FE5557ULL, 0x730499AF921549FFULL, 0x4E4B705B92903BA4ULL, 0xFF577222C14F0A3AULL,
+	0x55B6344CF97AAFAEULL, 0xB862225B055B6960ULL, 0xCAC09AFBDDD2CDB4ULL, 0xDAF8E9829FE96B5FULL,
+	0xB5FDFC5D3132C498ULL, 0x310CB380DB6F7503ULL, 0xE87FBB46217A360EULL, 0x2102AE466EBB1148ULL,
+	0xF8549E1A3AA5E00DULL, 0x07A69AFDCC42261AULL, 0xC4C118BFE78FEAAEULL, 0xF9F4892ED96BD438ULL,
+	0x1AF3DBE25D8F45DAULL, 0xF5B4B0B0D2DEEEB4ULL, 0x962ACEEFA82E1C84ULL, 0x046E3ECAAF453CE9ULL,
+	0xF05D129681949A4CULL, 0x964781CE734B3C84ULL, 0x9C2ED44081CE5FBDULL, 0x522E23F3925E319EULL,
+	0x177E00F9FC32F791ULL, 0x2BC60A63A6F3B3F2ULL, 0x222BBFAE61725606ULL, 0x486289DDCC3D6780ULL,
+	0x7DC7785B8EFDFC80ULL, 0x8AF38731C02BA980ULL, 0x1FAB64EA29A2DDF7ULL, 0xE4D9429322CD065AULL,
+	0x9DA058C67844F20CULL, 0x24C0E332B70019B0ULL, 0x233003B5A6CFE6ADULL, 0xD586BD01C5C217F6ULL,
+	0x5E5637885F29BC2BULL, 0x7EBA726D8C94094BULL, 0x0A56A5F0BFE39272ULL, 0xD79476A84EE20D06ULL,
+	0x9E4C1269BAA4BF37ULL, 0x17EFEE45B0DEE640ULL, 0x1D95B0A5FCF90BC6ULL, 0x93CBE0B699C2585DULL,
+	0x65FA4F227A2B6D79ULL, 0xD5F9E858292504D5ULL, 0xC2B5A03F71471A6FULL, 0x59300222B4561E00ULL,
+	0xCE2F8642CA0712DCULL, 0x7CA9723FBB2E8988ULL, 0x2785338347F2BA08ULL, 0xC61BB3A141E50E8CULL,
+	0x150F361DAB9DEC26ULL, 0x9F6A419D382595F4ULL, 0x64A53DC924FE7AC9ULL, 0x142DE49FFF7A7C3DULL,
+	0x0C335248857FA9E7ULL, 0x0A9C32D5EAE45305ULL, 0xE6C42178C4BBB92EULL, 0x71F1CE2490D20B07ULL,
+	0xF1BCC3D275AFE51AULL, 0xE728E8C83C334074ULL, 0x96FBF83A12884624ULL, 0x81A1549FD6573DA5ULL,
+	0x5FA7867CAF35E149ULL, 0x56986E2EF3ED091BULL, 0x917F1DD5F8886C61ULL, 0xD20D8C88C8FFE65FULL,
+	0x31D71DCE64B2C310ULL, 0xF165B587DF898190ULL, 0xA57E6339DD2CF3A0ULL, 0x1EF6E6DBB1961EC9ULL,
+	0x70CC73D90BC26E24ULL, 0xE21A6B35DF0C3AD7ULL, 0x003A93D8B2806962ULL, 0x1C99DED33CB890A1ULL,
+	0xCF3145DE0ADD4289ULL, 0xD0E4427A5514FB72ULL, 0x77C621CC9FB3A483ULL, 0x67A34DAC4356550BULL,
+	0xF8D626AAAF278509ULL
+};
+
+// The promotion piece of a book move, indexed by bits 12 to 14 of the move.
+static const PieceTypeType caBookPromotions[] =
+{
+	ePieceType_Null,
+	ePieceType_Knight,
+	ePieceType_Bishop,
+	ePieceType_Rook,
+	ePieceType_Queen
+};
+
+
+class COpeningBook
+{
+private:
+	CMemoryMappedFile m_File;
+	size_t m_nNumEntries;
+
+	// Private copy constructor and assignment operator; ie. disallow copying.
+	COpeningBook( const COpeningBook & Src );
+	COpeningBook & operator=( const COpeningBook & Src );
+
+	inline unsigned long long ReadBigEndian( size_t nOffset, int nNumBytes ) const
+	{
+		const unsigned char * const kpcData = m_File.GetData() + nOffset;
+		unsigned long long n = 0;
+
+		for( int i = 0; i < nNumBytes; ++i )
+		{
+			n = ( n << 8 ) | kpcData[i];
+		}
+
+		return( n );
+	}
+
+	inline HashKeyType GetKey( size_t nEntry ) const
+	{
+		return( ReadBigEndian( nEntry * cnBookEntrySize, 8 ) );
+	}
+
+	inline int GetMove( size_t nEntry ) const
+	{
+		return( (int)ReadBigEndian( nEntry * cnBookEntrySize + 8, 2 ) );
+	}
+
+	inline int GetWeight( size_t nEntry ) const
+	{
+		return( (int)ReadBigEndian( nEntry * cnBookEntrySize + 10, 2 ) );
+	}
+
+public:
+	COpeningBook( void )
+		: m_nNumEntries( 0 )
+	{
+	}
+
+	void Open( const char * pcPath ) throw( CException )
+	{
+		m_nNumEntries = 0;
+		m_File.Open( pcPath );
+		m_nNumEntries = m_File.GetSize() / cnBookEntrySize;
+	}
+
+	void Close( void )
+	{
+		m_File.Close();
+		m_nNumEntries = 0;
+	}
+
+	inline bool IsOpen( void ) const
+	{
+		return( m_File.IsOpen() );
+	}
+
+	bool Probe( HashKeyType nKey, CRandomNumberGenerator & rng, int & nSrcSquare, int & nDstSquare, PieceTypeType & PromotedTo ) const;
+}; // class COpeningBook
+
+
+bool COpeningBook::Probe( HashKeyType nKey, CRandomNumberGenerator & rng, int & nSrcSquare, int & nDstSquare, PieceTypeType & PromotedTo ) const
+{
+	// Find the position's first entry by binary search, then choose one of its
+	// moves with a probability proportional to the move's weight.  Castling is
+	// written as the king's move to its own rook's square.
+	size_t nLow = 0;
+	size_t nHigh = m_nNumEntries;
+
+	while( nLow < nHigh )
+	{
+		const size_t knMiddle = nLow + ( nHigh - nLow ) / 2;
+
+		if( GetKey( knMiddle ) < nKey )
+		{
+			nLow = knMiddle + 1;
+		}
+		else
+		{
+			nHigh = knMiddle;
+		}
+	}
+
+	int nTotalWeight = 0;
+
+	for( size_t i = nLow; i < m_nNumEntries  &&  GetKey( i ) == nKey; ++i )
+	{
+		nTotalWeight += GetWeight( i );
+	}
+
+	if( nTotalWeight == 0 )
+	{
+		return( false );
+	}
+
+	int nChoice = rng.GetNextBelow( nTotalWeight );
+	size_t nEntry = nLow;
+
+	while( nChoice >= GetWeight( nEntry ) )
+	{
+		nChoice -= GetWeight( nEntry );
+		++nEntry;
+	}
+
+	// The move: the destination square in bits 0 to 5, the source square in
+	// bits 6 to 11 (both numbered as ours are), and the promotion in bits 12 to 14.
+	const int knMove = GetMove( nEntry );
+	const int knPromotion = ( knMove >> 12 ) & 7;
+
+	if( knPromotion >= (int)( sizeof( caBookPromotions ) / sizeof( caBookPromotions[0] ) ) )
+	{
+		return( false );
+	}
+
+	nDstSquare = knMove & 63;
+	nSrcSquare = ( knMove >> 6 ) & 63;
+	PromotedTo = caBookPromotions[knPromotion];
+	return( true );
+}
+
+
+// **** Endgame tablebases ****
+
+// A tablebase holds the value, under perfect play, of every position with a
+// given set of pieces.  It is found by repeated forward passes over all of the
+// positions, rather than by retrograde analysis (unmaking moves from the positions
+// already resolved), which would need a generator of unmoves; see CGame::GenerateTablebase().
+// Each side's material is described by the number of pieces of each type other
+// than the king, and a table stores only the positions in which the stronger
+// side is White; the other positions are looked up with the board flipped.
+// A table is named for its material, eg. "KRK" or "KQKR", and is indexed by
+// the player to move, then the square of each piece: the stronger side's king,
+// queens, ..., pawns, then the weaker side's, with pieces of a type in
+// ascending order of square.  Positions with castling rights or an
+// en passant capture are not covered, but the generator allows for en passant
+// captures after the moves from a position.
+
+static const int cnMaxNumTablebasePieces = 4;
+
+// A table's entries: zero for a draw, or one plus the number of plies to mate,
+// which is odd if the player to move wins, and even if the player to move loses.
+static const unsigned char cnTablebaseDraw = 0;
+static const unsigned char cnTablebaseUnknown = 255;		// Only while a table is being generated.
+
+// The piece counts of a material key: two bits for each side (0 for the
+// stronger side, 1 for the weaker side) and each piece type other than the king.
+
+static inline int GetTablebasePieceCount( int nMaterialKey, int nSide, int nPieceType )
+{
+	return( ( nMaterialKey >> ( 2 * ( ( eNumPieceTypes - 1 ) * nSide + nPieceType - 1 ) ) ) & 3 );
+}
+
+
+static int MakeTablebaseMaterialKey( const int aanPieceCounts[2][eNumPieceTypes], int & nStrongerPlayerID )
+{
+	// The stronger side has more pieces, or the same number but of more valuable types.
+	int anNumPieces[2] = { 0, 0 };
+
+	for( int i = 0; i < 2; ++i )
+	{
+
+		for( int j = ePieceType_Queen; j < eNumPieceTypes; ++j )
+		{
+			anNumPieces[i] += aanPieceCounts[i][j];
+		}
+	}
+
+	nStrongerPlayerID = anNumPieces[1] > anNumPieces[0] ? 1 : 0;
+
+	for( int j = ePieceType_Queen; j < eNumPieceTypes  &&  anNumPieces[0] == anNumPieces[1]; ++j )
+	{
+
+		if( aanPieceCounts[0][j] != aanPieceCounts[1][j] )
+		{
+			nStrongerPlayerID = aanPieceCounts[1][j] > aanPieceCounts[0][j] ? 1 : 0;
+			break;
+		}
+	}
+
+	int nMaterialKey = 0;
+
+	for( int nSide = 0; nSide < 2; ++nSide )
+	{
+		const int knPlayerID = nSide == 0 ? nStrongerPlayerID : 1 - nStrongerPlayerID;
+
+		for( int j = ePieceType_Queen; j < eNumPieceTypes; ++j )
+		{
+			nMaterialKey |= aanPieceCounts[knPlayerID][j] << ( 2 * ( ( eNumPieceTypes - 1 ) * nSide + j - 1 ) );
+		}
+	}
+
+	return( nMaterialKey );
+}
+
+
+static int GetTablebaseNumPieces( int nMaterialKey )
+{
+	int nNumPieces = 2;
+
+	for( int nSide = 0; nSide < 2; ++nSide )
+	{
+
+		for( int j = ePieceType_Queen; j < eNumPieceTypes; ++j )
+		{
+			nNumPieces += GetTablebasePieceCount( nMaterialKey, nSide, j );
+		}
+	}
+
+	return( nNumPieces );
+}
+
+
+static inline unsigned long long GetTablebaseSize( int nMaterialKey )
+{
+	return( 2ULL << ( 6 * GetTablebaseNumPieces( nMaterialKey ) ) );
+}
+
+
+static void GetTablebasePieceCounts( int nMaterialKey, int aanPieceCounts[2][eNumPieceTypes] )
+{
+	// The piece counts of each side, with the stronger side as player 0.
+
+	for( int i = 0; i < 2; ++i )
+	{
+		aanPieceCounts[i][ePieceType_King] = 1;
+
+		for( int j = ePieceType_Queen; j < eNumPieceTypes; ++j )
+		{
+			aanPieceCounts[i][j] = GetTablebasePieceCount( nMaterialKey, i, j );
+		}
+	}
+}
+
+
+static bool IsCanonicalTablebaseMaterialKey( int nMaterialKey )
+{
+	// Does the key describe the stronger side's material first?
+	int aanPieceCounts[2][eNumPieceTypes];
+	int nStrongerPlayerID = 0;
+
+	GetTablebasePieceCounts( nMaterialKey, aanPieceCounts );
+	return( MakeTablebaseMaterialKey( aanPieceCounts, nStrongerPlayerID ) == nMaterialKey );
+}
+
+
+static void GetTablebaseDependencies( int nMaterialKey, vector<int> & dependencies )
+{
+	// The tables that captures and promotions lead to, including bare kings.
+	int aanPieceCounts[2][eNumPieceTypes];
+	int nStrongerPlayerID = 0;
+
+	GetTablebasePieceCounts( nMaterialKey, aanPieceCounts );
+	dependencies.clear();
+
+	for( int nSide = 0; nSide < 2; ++nSide )
+	{
+
+		for( int j = ePieceType_Queen; j < eNumPieceTypes; ++j )
+		{
+
+			if( aanPieceCounts[nSide][j] == 0 )
+			{
+				continue;
+			}
+
+			// The piece is captured.
+			--aanPieceCounts[nSide][j];
+			dependencies.push_back( MakeTablebaseMaterialKey( aanPieceCounts, nStrongerPlayerID ) );
+
+			if( j == ePieceType_Pawn )
+			{
+				// The pawn is promoted, with or without a capture.
+
+				for( int k = ePieceType_Queen; k < ePieceType_Pawn; ++k )
+				{
+					++aanPieceCounts[nSide][k];
+					dependencies.push_back( MakeTablebaseMaterialKey( aanPieceCounts, nStrongerPlayerID ) );
+
+					for( int m = ePieceType_Queen; m < ePieceType_Pawn; ++m )
+					{
+
+						if( aanPieceCounts[1 - nSide][m] > 0 )
+						{
+							--aanPieceCounts[1 - nSide][m];
+							dependencies.push_back( MakeTablebaseMaterialKey( aanPieceCounts, nStrongerPlayerID ) );
+							++aanPieceCounts[1 - nSide][m];
+						}
+					}
+
+					--aanPieceCounts[nSide][k];
+				}
+			}
+
+			++aanPieceCounts[nSide][j];
+		}
+	}
+}
+
+
+// **** Class CTablebases ****
+
+// The tablebases that are available to the search, by material key.  The
+// tables on disk are memory-mapped; the table being generated is in memory.
+
+class CTablebases
+{
+private:
+	map<int, const unsigned char *> m_Tables;
+	map<int, CAutoPtr<CMemoryMappedFile> > m_Files;
+	int m_nMaxNumPieces;
+
+	// Private copy constructor and assignment operator; ie. disallow copying.
+	CTablebases( const CTablebases & Src );
+	CTablebases & operator=( const CTablebases & Src );
+
+public:
+	CTablebases( void )
+		: m_nMaxNumPieces( 0 )
+	{
+	}
+
+	static string GetName( int nMaterialKey );
+	static string GetPath( const string & strDirectory, int nMaterialKey );
+
+	int Load( const string & strDirectory );
+	bool LoadTable( const string & strDirectory, int nMaterialKey );
+	void SetTable( int nMaterialKey, const unsigned char * pcTable );
+	void Clear( void );
+
+	inline const unsigned char * GetTable( int nMaterialKey ) const
+	{
+		const map<int, const unsigned char *>::const_iterator kIter = m_Tables.find( nMaterialKey );
+
+		return( kIter != m_Tables.end() ? kIter->second : 0 );
+	}
+
+	inline int GetMaxNumPieces( void ) const
+	{
+		return( m_nMaxNumPieces );
+	}
+}; // class CTablebases
+
+
+string CTablebases::GetName( int nMaterialKey )
+{
+	string strName;
+
+	for( int nSide = 0; nSide < 2; ++nSide )
+	{
+		strName += caPieceArchetypes[ePieceType_King].m_Printable;
+
+		for( int j = ePieceType_Queen; j < eNumPieceTypes; ++j )
+		{
+			strName.append( GetTablebasePieceCount( nMaterialKey, nSide, j ), caPieceArchetypes[j].m_Printable );
+		}
+	}
+
+	return( strName );
+}
+
+
+string CTablebases::GetPath( const string & strDirectory, int nMaterialKey )
+{
+	return( strDirectory + "/" + GetName( nMaterialKey ) + ".pdtb" );
+}
+
+
+int CTablebases::Load( const string & strDirectory )
+{
+	// Map every table in the directory that has no more than cnMaxNumTablebasePieces
+	// pieces, and return the number of tables found.
+	int nNumTables = 0;
+
+	Clear();
+
+	for( int nMaterialKey = 0; nMaterialKey < 1 << ( 4 * ( eNumPieceTypes - 1 ) ); ++nMaterialKey )
+	{
+		const int knNumPieces = GetTablebaseNumPieces( nMaterialKey );
+
+		if( knNumPieces > 2  &&  knNumPieces <= cnMaxNumTablebasePieces  &&  LoadTable( strDirectory, nMaterialKey ) )
+		{
+			++nNumTables;
+		}
+	}
+
+	return( nNumTables );
+}
+
+
+bool CTablebases::LoadTable( const string & strDirectory, int nMaterialKey )
+{
+	// Returns false if the table's file is missing or has the wrong size.
+	CAutoPtr<CMemoryMappedFile> pFile = new CMemoryMappedFile;
+
+	if( pFile == 0 )
+	{
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+
+	try
+	{
+		pFile->Open( GetPath( strDirectory, nMaterialKey ).c_str() );
+	}
+	catch( ... )
+	{
+		return( false );
+	}
+
+	if( pFile->GetSize() != GetTablebaseSize( nMaterialKey ) )
+	{
+		return( false );
+	}
+
+	m_Files[nMaterialKey] = pFile;
+	SetTable( nMaterialKey, pFile->GetData() );
+	return( true );
+}
+
+
+void CTablebases::SetTable( int nMaterialKey, const unsigned char * pcTable )
+{
+	// pcTable == 0 removes the table.  The caller owns a table that isn't mapped from a file.
+
+	if( pcTable != 0 )
+	{
+		m_Tables[nMaterialKey] = pcTable;
+		m_nMaxNumPieces = max( m_nMaxNumPieces, GetTablebaseNumPieces( nMaterialKey ) );
+	}
+	else
+	{
+		m_Tables.erase( nMaterialKey );
+		m_Files.erase( nMaterialKey );
+	}
+}
+
+
+void CTablebases::Clear( void )
+{
+	m_Tables.clear();
+	m_Files.clear();
+	m_nMaxNumPieces = 0;
+}
+
+
+// **** Class CSearchLimits ****
+
+// The budget for one iterative deepening search.  Zero means "no limit".
+// The first iteration always runs to completion, so that there is a move to play.
+
+class CSearchLimits
+{
+public:
+	int m_nMaxDepth;					// In plies, counting the root move.
+	unsigned long long m_nMaxNodes;
+	int m_nMaxTimeInMilliseconds;
+
+	CSearchLimits( int nMaxDepth = 0, unsigned long long nMaxNodes = 0, int nMaxTimeInMilliseconds = 0 )
+		: m_nMaxDepth( nMaxDepth ),
+			m_nMaxNodes( nMaxNodes ),
+			m_nMaxTimeInMilliseconds( nMaxTimeInMilliseconds )
+	{
+	}
+}; // class CSearchLimits
+
+
+// The time to spend on a move, given the time left on the clock, the increment,
+// and the number of moves to the next time control (zero if there isn't one).
+
+static int GetMoveTimeInMilliseconds( int nTimeLeft, int nIncrement, int nMovesToGo )
+{
+	// Spend an even share of the time left, plus most of the increment,
+	// but keep a little in reserve for the time that the GUI takes.
+	const int knMoveTime = nTimeLeft / ( nMovesToGo > 0 ? nMovesToGo : 30 ) + nIncrement * 3 / 4;
+
+	return( max( 1, min( knMoveTime, nTimeLeft - 50 ) ) );
+}
+
+
+static const int cnMaxSearchDepth = 64;
+static const int cnMaxSearchPly = 2 * cnMaxSearchDepth;		// The quiescence search goes beyond the nominal depth.
+static const ScoreType cnDeltaPruningMargin = 200;
+static const int cnNumKillerMoves = 2;
+static const int cnMaxHistoryValue = 1 << 24;		// The history table is scaled down when an entry reaches this.
+static const unsigned long long cnNodesBetweenTimeChecks = 1024;
+
+// Serializes the lines written to cout, which the search thread and the
+// thread that reads the GUI's commands both write to.
+static mutex gs_OutputMutex;
+
+
+// **** Class CSearchStatistics ****
+
+// What one search thread did.  Each thread counts on its own game, so the
+// counters need no locks; the helpers' counters are added to the main
+// thread's once the helpers have stopped.
+
+class CSearchStatistics
+{
+public:
+	unsigned long long m_nNumNodes;
+	unsigned long long m_nNumQuiescenceNodes;		// Included in m_nNumNodes.
+	unsigned long long m_nNumTranspositionTableProbes;
+	unsigned long long m_nNumTranspositionTableHits;
+	unsigned long long m_nNumFailHighs;
+	unsigned long long m_nNumFailHighsOnFirstMove;
+	int m_nMilliseconds;							// The time that the whole search took; set on the totals.
+
+	// The completed iterations, with the nodes searched and the time taken by the end of each.
+	int m_nNumIterations;
+	int m_anIterationDepths[cnMaxSearchDepth];
+	unsigned long long m_anIterationNodes[cnMaxSearchDepth];
+	int m_anIterationMilliseconds[cnMaxSearchDepth];
+
+	CSearchStatistics( void )
+	{
+		Clear();
+	}
+
+	void Clear( void )
+	{
+		m_nNumNodes = 0;
+		m_nNumQuiescenceNodes = 0;
+		m_nNumTranspositionTableProbes = 0;
+		m_nNumTranspositionTableHits = 0;
+		m_nNumFailHighs = 0;
+		m_nNumFailHighsOnFirstMove = 0;
+		m_nMilliseconds = 0;
+		m_nNumIterations = 0;
+	}
+
+	inline void AddIteration( int nDepth, unsigned long long nNumNodes, int nMilliseconds )
+	{
+
+		if( m_nNumIterations < cnMaxSearchDepth )
+		{
+			m_anIterationDepths[m_nNumIterations] = nDepth;
+			m_anIterationNodes[m_nNumIterations] = nNumNodes;
+			m_anIterationMilliseconds[m_nNumIterations] = nMilliseconds;
+			++m_nNumIterations;
+		}
+	}
+
+	void AddCounters( const CSearchStatistics & Src );
+	void WriteCountersJSON( ostream & os ) const;
+	void WriteIterationsJSON( ostream & os ) const;
+}; // class CSearchStatistics
+
+
+void CSearchStatistics::AddCounters( const CSearchStatistics & Src )
+{
+	// The iterations are per thread, and aren't added.
+	m_nNumNodes += Src.m_nNumNodes;
+	m_nNumQuiescenceNodes += Src.m_nNumQuiescenceNodes;
+	m_nNumTranspositionTableProbes += Src.m_nNumTranspositionTableProbes;
+	m_nNumTranspositionTableHits += Src.m_nNumTranspositionTableHits;
+	m_nNumFailHighs += Src.m_nNumFailHighs;
+	m_nNumFailHighsOnFirstMove += Src.m_nNumFailHighsOnFirstMove;
+}
+
+
+void CSearchStatistics::WriteCountersJSON( ostream & os ) const
+{
+	os << "\"nodes\":" << m_nNumNodes <<
+		",\"qnodes\":" << m_nNumQuiescenceNodes <<
+		",\"tt_probes\":" << m_nNumTranspositionTableProbes <<
+		",\"tt_hits\":" << m_nNumTranspositionTableHits <<
+		",\"fail_highs\":" << m_nNumFailHighs <<
+		",\"fail_highs_first\":" << m_nNumFailHighsOnFirstMove;
+}
+
+
+void CSearchStatistics::WriteIterationsJSON( ostream & os ) const
+{
+	// The effective branching factor of an iteration is the ratio of the nodes
+	// that it searched to the nodes that the previous iteration searched.
+	os << "[";
+
+	for( int i = 0; i < m_nNumIterations; ++i )
+	{
+		const unsigned long long knNumNodes = m_anIterationNodes[i] - ( i > 0 ? m_anIterationNodes[i - 1] : 0 );
+		const unsigned long long knNumPreviousNodes = i > 0 ? m_anIterationNodes[i - 1] - ( i > 1 ? m_anIterationNodes[i - 2] : 0 ) : 0;
+
+		os << ( i > 0 ? "," : "" ) << "{\"depth\":" << m_anIterationDepths[i] <<
+			",\"nodes\":" << knNumNodes <<
+			",\"time_ms\":" << m_anIterationMilliseconds[i] - ( i > 0 ? m_anIterationMilliseconds[i - 1] : 0 ) << ",\"ebf\":";
+
+		if( knNumPreviousNodes > 0 )
+		{
+			os << (double)knNumNodes / knNumPreviousNodes;
+		}
+		else
+		{
+			os << "null";
+		}
+
+		os << "}";
+	}
+
+	os << "]";
+}
+
+
+// **** Class CLegalityMasks ****
+
+// What the move generator needs to know, once per position, to generate
+// only legal moves: which of the opponent's pieces give check, and which
+// of the player's pieces are pinned to the king.
+
+class CLegalityMasks
+{
+public:
+	int m_nKingSquare;
+	BitboardType m_bbCheckers;			// The opponent's pieces that give check.
+	BitboardType m_bbCheckMask;			// The squares to which a piece other than the king may move to deal with a check.
+	BitboardType m_bbPinned;			// The player's pieces that can't leave the line between the king and an attacker.
+
+	inline BitboardType GetLegalDstSquares( int nSrcSquare ) const
+	{
+		// For a piece other than the king.
+
+		if( ( m_bbPinned & SquareToBitboard( nSrcSquare ) ) != 0 )
+		{
+			return( m_bbCheckMask & GetLineThrough( m_nKingSquare, nSrcSquare ) );
+		}
+
+		return( m_bbCheckMask );
+	}
+}; // class CLegalityMasks
+
+
+// **** Class CPlayer ****
+
+class CGame;
+class CMovePicker;
+
+class CPlayer
+{
+	friend class CGame;
+	friend class CMovePicker;
+	friend class CMatchRunner;
+
+private:
+	void GetLegalityMasks( CLegalityMasks & masks ) const;
+	void GenerateMoves( CMoveList & generatedMoves, GeneratedMoveType GenMoveType, const CLegalityMasks & masks ) const;
+	void GenerateMoves( CMoveList & generatedMoves, GeneratedMoveType GenMoveType ) const;
+	bool IsEnPassantLegal( int nSrcSquare, int nDstSquare ) const;
+	bool CanCastle( bool bKingside ) const;
+
+public:
+	const int m_knSelfID;				// 0 for White, 1 for Black.
+	CGame & m_Game;
+	CPlayer & m_Opponent;
+
+	CPlayer( int nSelfID, CGame & game, CPlayer & opponent );
+	void CreatePieces( void );
+	ScoreType TotalMaterialValue( void ) const;
+	bool IsInCheck( void ) const;
+	bool IsMovePseudoLegal( const CMove & move ) const;
+	bool IsMoveLegal( const CMove & move, const CLegalityMasks & masks ) const;
+	bool IsCaptureOrPromotion( const CMove & move ) const;
+	ScoreType GetCaptureGain( const CMove & move ) const;
+	ScoreType GetStaticExchangeValue( const CMove & move ) const;
+	ScoreType FindBestMove( CMove * pBestMove, int nPly, int nMaxPly, ScoreType nAlpha, ScoreType nBeta );
+	ScoreType Quiesce( int nPly, ScoreType nAlpha, ScoreType nBeta );
+	unsigned long long Perft( int nDepth );
+};
+
+
+CPlayer::CPlayer( int nSelfID, CGame & game, CPlayer & opponent )
+	: m_knSelfID( nSelfID ),
+		m_Game( game ),
+		m_Opponent( opponent )
+{
+}
+
+
+// The outcome of a game.
+
+enum GameResultType
+{
+	eGameResult_WhiteWins = 0,
+	eGameResult_Draw,
+	eGameResult_BlackWins
+};
+
+
+// **** Class CGame ****
+
+class CGame
+{
+	friend class CPlayer;
+	friend class CMovePicker;
+	friend class CUCIDriver;
+	friend class CTestSuiteRunner;
+	friend class CMatchRunner;
+
+private:
+	// The position: one bitboard per player and piece type,
+	// plus the squares occupied by each player and by either player.
+	BitboardType m_abbPieces[2][eNumPieceTypes];
+	BitboardType m_abbPlayerOccupancy[2];
+	BitboardType m_bbOccupancy;
+
+	CPlayer m_WhitePlayer;
+	CPlayer m_BlackPlayer;
+
+	int m_nPlayerToMove;				// 0 for White, 1 for Black.
+	int m_nCastlingRights;				// See CastlingRightsType.
+	int m_nPawnCapturableViaEnPassant;
+	int m_nHalfMoveClock;				// The number of plies since the last capture or pawn move.
+	int m_nFullMoveNumber;				// Starts at 1, and is incremented after Black's move.
+	HashKeyType m_nHashKey;
+
+	// The evaluation terms of each player, kept up to date as pieces are added, removed and moved.
+	ScoreType m_anMaterialValues[2];
+	ScoreType m_anPieceSquareValues[2];
+
+	// The moves made so far, in the game and in the search, so that they can be taken back.
+	CUndoRecord m_aUndoRecords[cnMaxNumUndoRecords];
+	int m_nNumUndoRecords;
+
+	CAutoPtr<CTranspositionTable> m_pTranspositionTable;
+	CAutoPtr<CTablebases> m_pTablebases;
+
+	// The state of the search in progress.  Each search thread has its own
+	// CGame; the main thread's CGame raises the helpers' stop flags.
+	int m_nNumSearchThreads;
+	CSearchLimits m_SearchLimits;
+	bool m_bEnforceSearchLimits;		// False during the first iteration.
+	atomic<bool> m_bStopSearch;
+	atomic<bool> m_bStopRequested;		// Raised by another thread; honoured like a spent budget.
+	unsigned long long m_nNumSearchNodes;
+	CGame * m_pMainThreadGame;			// A helper's main thread; 0 in the main thread.
+	atomic<unsigned long long> m_nNumHelperSearchNodes;	// The helpers' nodes so far, in batches.
+	chrono::steady_clock::time_point m_SearchStartTime;
+
+	// Quiet moves that recently caused cutoffs, by distance from the root.
+	CMove m_aaKillerMoves[cnMaxSearchPly][cnNumKillerMoves];
+
+	// The butterfly history table: how often each quiet move, by player and by
+	// source and destination squares, has caused a cutoff, weighted by depth.
+	int m_aaanHistory[2][cnBoardArea][cnBoardArea];
+
+	// The quiet move that last refuted each move, by the player who replied
+	// and by the piece type and destination square of the move replied to.
+	CMove m_aaaCounterMoves[2][eNumPieceTypes][cnBoardArea];
+
+	// What this thread's search did.  The proportion of cutoffs that are caused
+	// by the first move searched measures the quality of the move ordering.
+	CSearchStatistics m_SearchStatistics;
+
+	// Each thread's statistics from the last search, the main thread's first.
+	vector<CSearchStatistics> m_ThreadSearchStatistics;
+
+	// The moves of the positions on the current line, by distance from the root.
+	// It is allocated once, so that the search doesn't allocate memory.
+	vector<CMoveList> m_MoveStack;
+	CMoveList m_BestRootMoves;			// The moves that tie for best at the root.
+	CRandomNumberGenerator m_RandomNumberGenerator;	// Chooses among the best root moves.
+
+	void ClearBoard( void );
+	void InitializeBoard( void );
+	void PrintBoard( void ) const;
+	void ParseFEN( const char * pcFEN ) throw( CException );
+
+	PieceTypeType GetPieceTypeOnSquare( int nPlayerID, int nSquare ) const;
+	BitboardType GetAttackersOfSquare( int nSquare, BitboardType bbOccupancy ) const;
+	inline bool IsSquareAttacked( int nSquare, int nAttackerID, BitboardType bbOccupancy ) const;
+	inline bool IsSquareAttacked( int nSquare, int nAttackerID ) const;
+	inline void AddPiece( int nPlayerID, PieceTypeType PieceType, int nSquare );
+	inline void RemovePiece( int nPlayerID, PieceTypeType PieceType, int nSquare );
+	inline void MovePiece( int nPlayerID, PieceTypeType PieceType, int nSrcSquare, int nDstSquare );
+
+	HashKeyType ComputeHashKey( void ) const;
+	HashKeyType ComputePolyglotKey( void ) const;
+	int ComputePieceSquareValue( int nPlayerID ) const;
+	inline ScoreType Evaluate( void ) const;
+	inline HashKeyType GetCastlingAndEnPassantHashKey( void ) const;
+
+	PieceTypeType MakeMove( const CMove & move );
+	void UnmakeMove( void );
+	int CountRepetitions( void ) const;
+	bool HasInsufficientMaterial( void ) const;
+
+	inline void CountSearchNode( void );
+	inline CMove GetCounterMove( void ) const;
+	void RecordQuietCutoff( int nPly, int nDepth, const CMove & move );
+	int GetSearchTimeInMilliseconds( void ) const;
+	void PrepareSearch( const CSearchLimits & limits );
+	ScoreType IterativeDeepening( int nFirstDepth, CMove & bestMove, bool bReportProgress );
+	void RunHelperSearch( int nFirstDepth );
+
+	bool GetTablebaseIndex( int & nMaterialKey, unsigned long long & nIndex ) const;
+	bool SetUpTablebasePosition( int nMaterialKey, unsigned long long nIndex );
+	unsigned char GetTablebaseEntry( void ) const;
+	bool CanCaptureEnPassant( void ) const;
+	unsigned char GetTablebaseEntryAllowingEnPassant( void );
+	bool ProbeTablebases( int nPly, ScoreType & nScore ) const;
+	bool FindTablebaseMove( CMove & bestMove, ScoreType & nBestLineValue );
+	void RunTablebasePass( int nMaterialKey, unsigned char * pcTable, int nPass,
+		unsigned long long nBeginIndex, unsigned long long nEndIndex, vector<unsigned long long> * pResolvedIndices );
+	void GenerateTablebase( const string & strDirectory, int nMaterialKey ) throw( CException );
+	bool CheckTablebases( void ) throw( CException );
+
+public:
+
+	explicit CGame( int nTranspositionTableSizeInMB = cnDefaultTranspositionTableSizeInMB );
+	CGame( const CGame & Src );
+
+	void LoadFEN( const char * pcFEN ) throw( CException );
+	string ToFEN( void ) const;
+	string MoveToString( const CMove & move ) const;
+	CMove StringToMove( const string & strMove );
+	string MoveToSAN( const CMove & move );
+	CMove ProbeOpeningBook( const COpeningBook & book );
+	bool IsGameOver( GameResultType & result, string & strReason );
+
+	inline CPlayer & GetPlayerToMove( void )
+	{
+		return( m_nPlayerToMove == 0 ? m_WhitePlayer : m_BlackPlayer );
+	}
+
+	unsigned long long RunPerft( int nDepth, bool bDivide );
+	static bool RunPerftSuite( int nMaxDepth ) throw( CException );
+	static bool CheckPolyglotKeys( void ) throw( CException );
+	static void RunFENBenchmark( const char * pcPath ) throw( CException );
+
+	void SetNumSearchThreads( int nNumSearchThreads ) throw( CException );
+	void SetRandomSeed( unsigned long long nSeed );
+	ScoreType Search( const CSearchLimits & limits, CMove & bestMove, bool bReportProgress );
+	string GetSearchStatisticsJSON( void ) const;
+	static void RunSMPBenchmark( int nNumThreads, int nDepth, const char * pcFEN, unsigned long long nRandomSeed ) throw( CException );
+
+	int LoadTablebases( const string & strDirectory );
+	static bool GenerateTablebases( const string & strDirectory, int nMaxNumPieces ) throw( CException );
+
+	void Play( void ) throw( CException );
+
+}; // class CGame
+
+
+inline void CGame::AddPiece( int nPlayerID, PieceTypeType PieceType, int nSquare )
+{
+	const BitboardType kbbSquare = SquareToBitboard( nSquare );
+
+	m_abbPieces[nPlayerID][PieceType] |= kbbSquare;
+	m_abbPlayerOccupancy[nPlayerID] |= kbbSquare;
+	m_bbOccupancy |= kbbSquare;
+	m_nHashKey ^= cZobristKeys.m_anPieceKeys[nPlayerID][PieceType][nSquare];
+	m_anMaterialValues[nPlayerID] += caPieceArchetypes[PieceType].m_nValue;
+	m_anPieceSquareValues[nPlayerID] += cPieceSquareValues.m_anValues[nPlayerID][PieceType][nSquare];
+}
+
+
+inline void CGame::RemovePiece( int nPlayerID, PieceTypeType PieceType, int nSquare )
+{
+	const BitboardType kbbSquare = SquareToBitboard( nSquare );
+
+	m_abbPieces[nPlayerID][PieceType] &= ~kbbSquare;
+	m_abbPlayerOccupancy[nPlayerID] &= ~kbbSquare;
+	m_bbOccupancy &= ~kbbSquare;
+	m_nHashKey ^= cZobristKeys.m_anPieceKeys[nPlayerID][PieceType][nSquare];
+	m_anMaterialValues[nPlayerID] -= caPieceArchetypes[PieceType].m_nValue;
+	m_anPieceSquareValues[nPlayerID] -= cPieceSquareValues.m_anValues[nPlayerID][PieceType][nSquare];
+}
+
+
+inline void CGame::MovePiece( int nPlayerID, PieceTypeType PieceType, int nSrcSquare, int nDstSquare )
+{
+	// The destination square must be vacant.
+	const BitboardType kbbSrcAndDst = SquareToBitboard( nSrcSquare ) | SquareToBitboard( nDstSquare );
+
+	m_abbPieces[nPlayerID][PieceType] ^= kbbSrcAndDst;
+	m_abbPlayerOccupancy[nPlayerID] ^= kbbSrcAndDst;
+	m_bbOccupancy ^= kbbSrcAndDst;
+	m_nHashKey ^= cZobristKeys.m_anPieceKeys[nPlayerID][PieceType][nSrcSquare] ^
+		cZobristKeys.m_anPieceKeys[nPlayerID][PieceType][nDstSquare];
+	m_anPieceSquareValues[nPlayerID] += cPieceSquareValues.m_anValues[nPlayerID][PieceType][nDstSquare] -
+		cPieceSquareValues.m_anValues[nPlayerID][PieceType][nSrcSquare];
+}
+
+
+inline ScoreType CGame::Evaluate( void ) const
+{
+	// The static evaluation from the point of view of the player to move:
+	// the difference in material, plus the difference in piece placement.
+	const int knPlayerID = m_nPlayerToMove;
+	const int knOpponentID = 1 - knPlayerID;
+
+	return( m_anMaterialValues[knPlayerID] - m_anMaterialValues[knOpponentID] +
+		m_anPieceSquareValues[knPlayerID] - m_anPieceSquareValues[knOpponentID] );
+}
+
+
+inline void CGame::CountSearchNode( void )
+{
+	// Raise the stop flag once the budget is spent.  Reading the clock is
+	// comparatively slow, so the time is only checked every so many nodes.
+	// The node limit is for all of the threads together; the helpers add their
+	// nodes to the main thread's game every so many nodes, so as not to contend for it.
+	++m_nNumSearchNodes;
+
+	if( m_pMainThreadGame != 0 )
+	{
+
+		if( m_nNumSearchNodes % cnNodesBetweenTimeChecks == 0 )
+		{
+			m_pMainThreadGame->m_nNumHelperSearchNodes += cnNodesBetweenTimeChecks;
+		}
+
+		return;
+	}
+
+	if( !m_bEnforceSearchLimits )
+	{
+		return;
+	}
+
+	if( m_bStopRequested )
+	{
+		m_bStopSearch = true;
+	}
+	else if( m_SearchLimits.m_nMaxNodes != 0  &&  m_nNumSearchNodes + m_nNumHelperSearchNodes >= m_SearchLimits.m_nMaxNodes )
+	{
+		m_bStopSearch = true;
+	}
+	else if( m_SearchLimits.m_nMaxTimeInMilliseconds != 0  &&
+		m_nNumSearchNodes % cnNodesBetweenTimeChecks == 0  &&
+		GetSearchTimeInMilliseconds() >= m_SearchLimits.m_nMaxTimeInMilliseconds )
+	{
+		m_bStopSearch = true;
+	}
+}
+
+
+inline bool CGame::IsSquareAttacked( int nSquare, int nAttackerID, BitboardType bbOccupancy ) const
+{
+	// Work backwards from the square: a piece attacks the square if a piece
+	// of the same kind on the square would attack it.  For pawns, the kind
+	// is a pawn of the other player.  The cheapest tests come first.
+	// The sliding pieces are blocked by the given occupied squares.
+	const BitboardType * const kabbAttackers = m_abbPieces[nAttackerID];
+
+	return( ( cLeaperAttackTables.m_abbPawnAttacks[1 - nAttackerID][nSquare] & kabbAttackers[ePieceType_Pawn] ) != 0  ||
+		( cLeaperAttackTables.m_abbKnightAttacks[nSquare] & kabbAttackers[ePieceType_Knight] ) != 0  ||
+		( cLeaperAttackTables.m_abbKingAttacks[nSquare] & kabbAttackers[ePieceType_King] ) != 0  ||
+		( GetBishopAttacks( nSquare, bbOccupancy ) &
+			( kabbAttackers[ePieceType_Bishop] | kabbAttackers[ePieceType_Queen] ) ) != 0  ||
+		( GetRookAttacks( nSquare, bbOccupancy ) &
+			( kabbAttackers[ePieceType_Rook] | kabbAttackers[ePieceType_Queen] ) ) != 0 );
+}
+
+
+inline bool CGame::IsSquareAttacked( int nSquare, int nAttackerID ) const
+{
+	return( IsSquareAttacked( nSquare, nAttackerID, m_bbOccupancy ) );
+}
+
+
+inline CMove CGame::GetCounterMove( void ) const
+{
+	// The move that last refuted the opponent's previous move, if any.
+
+	if( m_nNumUndoRecords == 0 )
+	{
+		return( CMove() );
+	}
+
+	const CUndoRecord & kPreviousMove = m_aUndoRecords[m_nNumUndoRecords - 1];
+
+	return( m_aaaCounterMoves[m_nPlayerToMove][kPreviousMove.m_MovingPieceType][kPreviousMove.m_Move.GetDstSquare()] );
+}
+
+
+inline HashKeyType CGame::GetCastlingAndEnPassantHashKey( void ) const
+{
+	HashKeyType nKey = cZobristKeys.m_anCastlingRightsKeys[m_nCastlingRights];
+
+	if( m_nPawnCapturableViaEnPassant >= 0 )
+	{
+		nKey ^= cZobristKeys.m_anEnPassantKeys[m_nPawnCapturableViaEnPassant % 8];
+	}
+
+	return( nKey );
+}
+
+
+ScoreType CPlayer::TotalMaterialValue( void ) const
+{
+	return( m_Game.m_anMaterialValues[m_knSelfID] );
+}
+
+
+void CPlayer::CreatePieces( void )
+{
+	const int knBackRow = 7 * m_knSelfID;
+	const int knFrontRow = 5 * m_knSelfID + 1;
+
+	m_Game.AddPiece( m_knSelfID, ePieceType_Rook, knBackRow * 8 + 0 );
+	m_Game.AddPiece( m_knSelfID, ePieceType_Knight, knBackRow * 8 + 1 );
+	m_Game.AddPiece( m_knSelfID, ePieceType_Bishop, knBackRow * 8 + 2 );
+	m_Game.AddPiece( m_knSelfID, ePieceType_Queen, knBackRow * 8 + 3 );
+	m_Game.AddPiece( m_knSelfID, ePieceType_King, knBackRow * 8 + 4 );
+	m_Game.AddPiece( m_knSelfID, ePieceType_Bishop, knBackRow * 8 + 5 );
+	m_Game.AddPiece( m_knSelfID, ePieceType_Knight, knBackRow * 8 + 6 );
+	m_Game.AddPiece( m_knSelfID, ePieceType_Rook, knBackRow * 8 + 7 );
+
+	for( int i = 0; i < 8; ++i )
+	{
+		m_Game.AddPiece( m_knSelfID, ePieceType_Pawn, knFrontRow * 8 + i );
+	}
+}
+
+
+void CPlayer::GetLegalityMasks( CLegalityMasks & masks ) const
+{
+	const int knKingSquare = BitScanForward( m_Game.m_abbPieces[m_knSelfID][ePieceType_King] );
+	const BitboardType * const kabbOpponentsPieces = m_Game.m_abbPieces[m_Opponent.m_knSelfID];
+	const BitboardType kbbOccupancy = m_Game.m_bbOccupancy;
+
+	masks.m_nKingSquare = knKingSquare;
+	masks.m_bbCheckers = m_Game.GetAttackersOfSquare( knKingSquare, kbbOccupancy ) &
+		m_Game.m_abbPlayerOccupancy[m_Opponent.m_knSelfID];
+	masks.m_bbPinned = 0;
+
+	if( masks.m_bbCheckers == 0 )
+	{
+		masks.m_bbCheckMask = ~0ULL;
+	}
+	else if( ( masks.m_bbCheckers & ( masks.m_bbCheckers - 1 ) ) == 0 )
+	{
+		// Capture the checking piece, or block it.
+		masks.m_bbCheckMask = masks.m_bbCheckers | GetSquaresBetween( knKingSquare, BitScanForward( masks.m_bbCheckers ) );
+	}
+	else
+	{
+		// Double check: only the king can move.
+		masks.m_bbCheckMask = 0;
+	}
+
+	// A piece is pinned if it is the only piece between the king and a sliding
+	// piece of the opponent that would otherwise attack the king.
+	BitboardType bbSnipers =
+		( GetRookAttacks( knKingSquare, 0 ) & ( kabbOpponentsPieces[ePieceType_Rook] | kabbOpponentsPieces[ePieceType_Queen] ) ) |
+		( GetBishopAttacks( knKingSquare, 0 ) & ( kabbOpponentsPieces[ePieceType_Bishop] | kabbOpponentsPieces[ePieceType_Queen] ) );
+
+	while( bbSnipers != 0 )
+	{
+		const BitboardType kbbBlockers = GetSquaresBetween( knKingSquare, PopLowestBit( bbSnipers ) ) & kbbOccupancy;
+
+		if( kbbBlockers != 0  &&  ( kbbBlockers & ( kbbBlockers - 1 ) ) == 0 )
+		{
+			masks.m_bbPinned |= kbbBlockers & m_Game.m_abbPlayerOccupancy[m_knSelfID];
+		}
+	}
+}
+
+
+bool CPlayer::IsEnPassantLegal( int nSrcSquare, int nDstSquare ) const
+{
+	// Two pawns leave the capturing pawn's row at once, so the usual pin
+	// test doesn't apply; look for attacks on the king after the capture.
+	const BitboardType kbbCapturedPawn = SquareToBitboard( ( nSrcSquare / 8 ) * 8 + nDstSquare % 8 );
+	const BitboardType kbbOccupancy = ( m_Game.m_bbOccupancy ^ SquareToBitboard( nSrcSquare ) ^ kbbCapturedPawn ) |
+		SquareToBitboard( nDstSquare );
+	const int knKingSquare = BitScanForward( m_Game.m_abbPieces[m_knSelfID][ePieceType_King] );
+
+	return( ( m_Game.GetAttackersOfSquare( knKingSquare, kbbOccupancy ) & m_Game.m_abbPlayerOccupancy[m_Opponent.m_knSelfID] ) == 0 );
+}
+
+
+void CPlayer::GenerateMoves( CMoveList & generatedMoves, GeneratedMoveType GenMoveType ) const
+{
+	CLegalityMasks masks;
+
+	GetLegalityMasks( masks );
+	GenerateMoves( generatedMoves, GenMoveType, masks );
+}
+
+
+void CPlayer::GenerateMoves( CMoveList & generatedMoves, GeneratedMoveType GenMoveType, const CLegalityMasks & masks ) const
+{
+	// Generate the player's legal moves of the given type:
+	// eGenMoveType_All : All moves, including castling;
+	// eGenMoveType_Capturing : Captures and promotions;
+	// eGenMoveType_Quiet : The rest of the moves, including castling.
+	// The moves are not ordered; CMovePicker does that.
+	// masks must have been computed for the current position.
+	const bool kbCapturing = GenMoveType != eGenMoveType_Quiet;
+	const bool kbQuiet = GenMoveType == eGenMoveType_All  ||  GenMoveType == eGenMoveType_Quiet;
+	const int knOpponentID = m_Opponent.m_knSelfID;
+	const int knBackRow = 7 * m_knSelfID;
+	const int knPawnStartRow = 5 * m_knSelfID + 1;
+	const int knPawnPromotionRow = 7 * ( 1 - m_knSelfID );
+	const int knPawnRowVector = 1 - 2 * m_knSelfID;
+	const BitboardType kbbOpponentsPieces = m_Game.m_abbPlayerOccupancy[knOpponentID];
+	const BitboardType kbbOccupancy = m_Game.m_bbOccupancy;
+	BitboardType bbPieces = m_Game.m_abbPieces[m_knSelfID][ePieceType_Pawn];
+	BitboardType bbTargets = 0;
+
+	generatedMoves.Clear();
+
+	while( bbPieces != 0 )
+	{
+		// Generate all possible pawn moves.
+		const int knSrcIndex = PopLowestBit( bbPieces );
+		const int knSrcRow = knSrcIndex / 8;
+		const int knSrcCol = knSrcIndex % 8;
+		const BitboardType kbbLegalDstSquares = masks.GetLegalDstSquares( knSrcIndex );
+		int nDstIndex = 0;
+
+		// For pawns, be aware of:
+		// 1) 1- or 2-square initial move ahead;
+		// 2) Move forward, capture diagonally;
+		// 3) Capturing en passant;
+		// 4) Pawn promotion to knight, bishop, rook, or queen.
+
+		// Try to move the pawn ahead one square.
+		// A pawn never stands on its promotion row, so the destination is on the board.
+		nDstIndex = knSrcIndex + 8 * knPawnRowVector;
+
+		if( ( kbbOccupancy & SquareToBitboard( nDstIndex ) ) == 0 )
+		{
+			// Move the pawn ahead one square.
+
+			if( ( kbbLegalDstSquares & SquareToBitboard( nDstIndex ) ) == 0 )
+			{
+				// The move doesn't deal with a check, or it breaks a pin.
+			}
+			else if( nDstIndex / 8 == knPawnPromotionRow )
+			{
+
+				if( kbCapturing )
+				{
+					// Promote the pawn (without capture).
+					generatedMoves.Add( CMove( knSrcIndex, nDstIndex, ePieceType_Queen ) );
+					generatedMoves.Add( CMove( knSrcIndex, nDstIndex, ePieceType_Rook ) );
+					generatedMoves.Add( CMove( knSrcIndex, nDstIndex, ePieceType_Bishop ) );
+					generatedMoves.Add( CMove( knSrcIndex, nDstIndex, ePieceType_Knight ) );
+				}
+			}
+			else if( kbQuiet )
+			{
+				generatedMoves.Add( CMove( knSrcIndex, nDstIndex ) );
+			}
+
+			// Try to move the pawn ahead two squares if it's the pawn's first move.
+
+			if( kbQuiet  &&  knSrcRow == knPawnStartRow )
+			{
+				nDstIndex += 8 * knPawnRowVector;
+
+				if( ( kbbOccupancy & SquareToBitboard( nDstIndex ) ) == 0  &&
+						( kbbLegalDstSquares & SquareToBitboard( nDstIndex ) ) != 0 )
+				{
+					// Move the pawn ahead two squares.
+					// Pawn promotion is impossible here.
+					generatedMoves.Add( CMove( knSrcIndex, nDstIndex ) );
+				}
+			}
+		}
+
+		if( !kbCapturing )
+		{
+			continue;
+		}
+
+		// Try to attack diagonally.
+		BitboardType bbDstSquares = cLeaperAttackTables.m_abbPawnAttacks[m_knSelfID][knSrcIndex] & kbbOpponentsPieces &
+			kbbLegalDstSquares;
+
+		while( bbDstSquares != 0 )
+		{
+			nDstIndex = PopLowestBit( bbDstSquares );
+
+			if( nDstIndex / 8 == knPawnPromotionRow )
+			{
+				// Promote the pawn (with capture).
+				generatedMoves.Add( CMove( knSrcIndex, nDstIndex, ePieceType_Queen ) );
+				generatedMoves.Add( CMove( knSrcIndex, nDstIndex, ePieceType_Rook ) );
+				generatedMoves.Add( CMove( knSrcIndex, nDstIndex, ePieceType_Bishop ) );
+				generatedMoves.Add( CMove( knSrcIndex, nDstIndex, ePieceType_Knight ) );
+			}
+			else
+			{
+				// Capture diagonally.
+				generatedMoves.Add( CMove( knSrcIndex, nDstIndex ) );
+			}
+		}
+
+		// Try to capture en passant.
+
+		if( m_Game.m_nPawnCapturableViaEnPassant >= 0  &&  m_Game.m_nPawnCapturableViaEnPassant < 64 )
+		{
+			const int knCapturablePawnRow = m_Game.m_nPawnCapturableViaEnPassant / 8;
+			const int knCapturablePawnCol = m_Game.m_nPawnCapturableViaEnPassant % 8;
+
+			// Assert( knCapturablePawnRow == 4 - m_knSelfID );
+
+			if( knCapturablePawnRow == knSrcRow  &&
+					abs( knCapturablePawnCol - knSrcCol ) == 1 )
+			{
+				nDstIndex = ( knSrcRow + knPawnRowVector ) * 8 + knCapturablePawnCol;
+
+				// A pawn is capturing another pawn.  No promotion.
+
+				if( IsEnPassantLegal( knSrcIndex, nDstIndex ) )
+				{
+					generatedMoves.Add( CMove( knSrcIndex, nDstIndex, eMoveFlags_EnPassant ) );
+				}
+			}
+		}
+	}
+
+	// The other pieces move to the squares that they attack.
+	bbTargets = ( kbCapturing ? kbbOpponentsPieces : 0 ) | ( kbQuiet ? ~kbbOccupancy : 0 );
+
+	for( int nPieceType = ePieceType_King; nPieceType < ePieceType_Pawn; ++nPieceType )
+	{
+		bbPieces = m_Game.m_abbPieces[m_knSelfID][nPieceType];
+
+		while( bbPieces != 0 )
+		{
+			// Look up the squares that the piece attacks; for a sliding piece,
+			// the first piece in each direction blocks the rest of the ray.
+			const int knSrcIndex = PopLowestBit( bbPieces );
+			BitboardType bbDstSquares = GetPieceAttacks( (PieceTypeType)nPieceType, knSrcIndex, kbbOccupancy ) & bbTargets;
+
+			if( nPieceType != ePieceType_King )
+			{
+				bbDstSquares &= masks.GetLegalDstSquares( knSrcIndex );
+			}
+
+			while( bbDstSquares != 0 )
+			{
+				const int knDstIndex = PopLowestBit( bbDstSquares );
+
+				// The king must not move to an attacked square, including one
+				// on the far side of it from a sliding piece that gives check.
+
+				if( nPieceType != ePieceType_King  ||
+						!m_Game.IsSquareAttacked( knDstIndex, knOpponentID, kbbOccupancy ^ SquareToBitboard( knSrcIndex ) ) )
+				{
+					generatedMoves.Add( CMove( knSrcIndex, knDstIndex ) );
+				}
+			}
+		}
+	}
+
+	if( kbQuiet )
+	{
+		// Castling is represented by the king's move.
+
+		if( CanCastle( true ) )
+		{
+			generatedMoves.Add( CMove( knBackRow * 8 + 4, knBackRow * 8 + 6, eMoveFlags_Castling ) );
+		}
+
+		if( CanCastle( false ) )
+		{
+			generatedMoves.Add( CMove( knBackRow * 8 + 4, knBackRow * 8 + 2, eMoveFlags_Castling ) );
+		}
+	}
+}
+
+
+bool CPlayer::CanCastle( bool bKingside ) const
+{
+	// 1) The king and the rook must not have been moved yet;
+	// 2) The squares between the king and the rook must be empty;
+	// 3) The squares that the king moves through and to must not be under attack;
+	// 4) The king must not be in check (you can't castle to escape check).
+	const int knBackRow = 7 * m_knSelfID;
+	const BitboardType kbbGap = ( bKingside ? 0x60ULL : 0x0EULL ) << ( knBackRow * 8 );	// f1 and g1, or b1, c1 and d1.
+	const int knFirstKingCol = bKingside ? 4 : 2;	// The king passes through e1 to g1, or through c1 to e1.
+
+	if( ( m_Game.m_nCastlingRights & GetCastlingRight( m_knSelfID, bKingside ) ) == 0  ||
+			( m_Game.m_bbOccupancy & kbbGap ) != 0 )
+	{
+		return( false );
+	}
+
+	for( int nCol = knFirstKingCol; nCol < knFirstKingCol + 3; ++nCol )
+	{
+
+		if( m_Game.IsSquareAttacked( knBackRow * 8 + nCol, m_Opponent.m_knSelfID ) )
+		{
+			return( false );
+		}
+	}
+
+	return( true );
+}
+
+
+bool CPlayer::IsMovePseudoLegal( const CMove & move ) const
+{
+	// Could the player make the move, if it weren't for leaving the king in check?
+	// Moves from the transposition table and killer moves were found in
+	// other positions, so they must be checked before they are made.
+	const int knSrcSquare = move.GetSrcSquare();
+	const int knDstSquare = move.GetDstSquare();
+	const int knFlags = move.GetFlags();
+
+	if( move.IsCastling() )
+	{
+		const int knBackRow = 7 * m_knSelfID;
+
+		return( knSrcSquare == knBackRow * 8 + 4  &&
+			( knDstSquare == knBackRow * 8 + 6  ||  knDstSquare == knBackRow * 8 + 2 )  &&
+			CanCastle( knDstSquare % 8 == 6 ) );
+	}
+
+	if( knFlags != eMoveFlags_Normal  &&  knFlags != eMoveFlags_EnPassant  &&
+			( !move.IsPromotion()  ||  move.GetPromotedTo() > ePieceType_Knight ) )
+	{
+		return( false );
+	}
+
+	const PieceTypeType kMovingPieceType = m_Game.GetPieceTypeOnSquare( m_knSelfID, knSrcSquare );
+	const BitboardType kbbDst = SquareToBitboard( knDstSquare );
+
+	if( kMovingPieceType == ePieceType_Null  ||  ( m_Game.m_abbPlayerOccupancy[m_knSelfID] & kbbDst ) != 0 )
+	{
+		return( false );
+	}
+
+	if( kMovingPieceType != ePieceType_Pawn )
+	{
+		return( knFlags == eMoveFlags_Normal  &&
+			( GetPieceAttacks( kMovingPieceType, knSrcSquare, m_Game.m_bbOccupancy ) & kbbDst ) != 0 );
+	}
+
+	// A pawn move must promote if and only if it reaches the last row.
+	const int knPawnRowVector = 1 - 2 * m_knSelfID;
+
+	if( ( knDstSquare / 8 == 7 * ( 1 - m_knSelfID ) ) != move.IsPromotion() )
+	{
+		return( false );
+	}
+
+	if( ( cLeaperAttackTables.m_abbPawnAttacks[m_knSelfID][knSrcSquare] & kbbDst ) != 0 )
+	{
+		// A diagonal move must capture, perhaps en passant.
+
+		if( move.IsEnPassant() )
+		{
+			return( m_Game.m_nPawnCapturableViaEnPassant == knDstSquare - 8 * knPawnRowVector );
+		}
+
+		return( ( m_Game.m_abbPlayerOccupancy[m_Opponent.m_knSelfID] & kbbDst ) != 0 );
+	}
+
+	// A move ahead must be to a vacant square; a move two squares ahead must
+	// be the pawn's first move, and must not jump over a piece.
+
+	if( move.IsEnPassant()  ||  ( m_Game.m_bbOccupancy & kbbDst ) != 0 )
+	{
+		return( false );
+	}
+
+	if( knDstSquare == knSrcSquare + 8 * knPawnRowVector )
+	{
+		return( true );
+	}
+
+	return( knDstSquare == knSrcSquare + 16 * knPawnRowVector  &&
+		knSrcSquare / 8 == 5 * m_knSelfID + 1  &&
+		( m_Game.m_bbOccupancy & SquareToBitboard( knSrcSquare + 8 * knPawnRowVector ) ) == 0 );
+}
+
+
+bool CPlayer::IsMoveLegal( const CMove & move, const CLegalityMasks & masks ) const
+{
+	// Is the move one that GenerateMoves( ..., eGenMoveType_All, masks ) would generate?
+	const int knSrcSquare = move.GetSrcSquare();
+	const int knDstSquare = move.GetDstSquare();
+
+	if( !IsMovePseudoLegal( move ) )
+	{
+		return( false );
+	}
+
+	if( move.IsCastling() )
+	{
+		// CanCastle() has checked the squares that the king crosses.
+		return( true );
+	}
+	else if( knSrcSquare == masks.m_nKingSquare )
+	{
+		return( !m_Game.IsSquareAttacked( knDstSquare, m_Opponent.m_knSelfID,
+			m_Game.m_bbOccupancy ^ SquareToBitboard( knSrcSquare ) ) );
+	}
+	else if( move.IsEnPassant() )
+	{
+		return( IsEnPassantLegal( knSrcSquare, knDstSquare ) );
+	}
+
+	return( ( masks.GetLegalDstSquares( knSrcSquare ) & SquareToBitboard( knDstSquare ) ) != 0 );
+}
+
+
+bool CPlayer::IsCaptureOrPromotion( const CMove & move ) const
+{
+	// Would GenerateMoves( ..., eGenMoveType_Capturing ) generate this move?
+	// The move must be legal.
+	return( move.IsPromotion()  ||  move.IsEnPassant()  ||
+		( m_Game.m_abbPlayerOccupancy[m_Opponent.m_knSelfID] & SquareToBitboard( move.GetDstSquare() ) ) != 0 );
+}
+
+
+ScoreType CPlayer::GetCaptureGain( const CMove & move ) const
+{
+	// The material that the move wins, not counting any recapture:
+	// the captured piece, plus the promotion of the pawn.
+	const PieceTypeType kCapturedPieceType = move.IsEnPassant() ? ePieceType_Pawn :
+		m_Game.GetPieceTypeOnSquare( m_Opponent.m_knSelfID, move.GetDstSquare() );
+	ScoreType nGain = 0;
+
+	if( kCapturedPieceType != ePieceType_Null )
+	{
+		nGain = caPieceArchetypes[kCapturedPieceType].m_nValue;
+	}
+
+	if( move.IsPromotion() )
+	{
+		nGain += caPieceArchetypes[move.GetPromotedTo()].m_nValue - caPieceArchetypes[ePieceType_Pawn].m_nValue;
+	}
+
+	return( nGain );
+}
+
+
+ScoreType CPlayer::GetStaticExchangeValue( const CMove & move ) const
+{
+	// The material that the move wins once the players have taken turns
+	// recapturing on the destination square, each with their least valuable
+	// piece, and each free to stop when recapturing no longer pays.
+	// Pieces that are revealed behind the capturers join in.  Pins are ignored.
+	const int knDstSquare = move.GetDstSquare();
+	ScoreType anGains[32];
+	int nNumCaptures = 0;
+	BitboardType bbOccupancy = m_Game.m_bbOccupancy ^ SquareToBitboard( move.GetSrcSquare() );
+	ScoreType nCapturerValue = caPieceArchetypes[m_Game.GetPieceTypeOnSquare( m_knSelfID, move.GetSrcSquare() )].m_nValue;
+	int nPlayerID = m_Opponent.m_knSelfID;
+
+	anGains[0] = GetCaptureGain( move );
+
+	if( move.IsPromotion() )
+	{
+		nCapturerValue = caPieceArchetypes[move.GetPromotedTo()].m_nValue;
+	}
+
+	if( move.IsEnPassant() )
+	{
+		bbOccupancy ^= SquareToBitboard( ( move.GetSrcSquare() / 8 ) * 8 + knDstSquare % 8 );
+	}
+
+	for( ;; )
+	{
+		const BitboardType kbbAttackers = m_Game.GetAttackersOfSquare( knDstSquare, bbOccupancy ) &
+			m_Game.m_abbPlayerOccupancy[nPlayerID];
+		int nPieceType = ePieceType_Pawn;
+
+		if( kbbAttackers == 0 )
+		{
+			break;
+		}
+
+		// Find the least valuable attacker.  The piece types are listed from the king to the pawn.
+
+		while( ( kbbAttackers & m_Game.m_abbPieces[nPlayerID][nPieceType] ) == 0 )
+		{
+			--nPieceType;
+		}
+
+		++nNumCaptures;
+		anGains[nNumCaptures] = nCapturerValue - anGains[nNumCaptures - 1];
+
+		if( nNumCaptures == 31  ||  max( -anGains[nNumCaptures - 1], anGains[nNumCaptures] ) < 0 )
+		{
+			// Neither player can gain by continuing.
+			break;
+		}
+
+		bbOccupancy ^= SquareToBitboard( BitScanForward( kbbAttackers & m_Game.m_abbPieces[nPlayerID][nPieceType] ) );
+		nCapturerValue = caPieceArchetypes[nPieceType].m_nValue;
+		nPlayerID = 1 - nPlayerID;
+	}
+
+	// Work backwards: each player recaptures only if it gains by doing so.
+
+	while( nNumCaptures > 0 )
+	{
+		anGains[nNumCaptures - 1] = -max( -anGains[nNumCaptures - 1], anGains[nNumCaptures] );
+		--nNumCaptures;
+	}
+
+	return( anGains[0] );
+}
+
+
+bool CPlayer::IsInCheck( void ) const
+{
+	// Is this player's king attacked by any of the opponent's pieces?
+	const int knKingSquare = BitScanForward( m_Game.m_abbPieces[m_knSelfID][ePieceType_King] );
+
+	return( m_Game.IsSquareAttacked( knKingSquare, m_Opponent.m_knSelfID ) );
+}
+
+
+// **** Class CMovePicker ****
+
+// Hands out the moves of a position one at a time, in the order in which the
+// search should try them, generating each group of moves only when it is
+// needed.  Cutoffs usually come early, so most nodes never generate quiet moves.
+
+enum MovePickerStageType
+{
+	eMovePickerStage_HashMove = 0,
+	eMovePickerStage_GenerateCaptures,
+	eMovePickerStage_Captures,
+	eMovePickerStage_Killers,
+	eMovePickerStage_CounterMove,
+	eMovePickerStage_GenerateQuietMoves,
+	eMovePickerStage_QuietMoves,
+	eMovePickerStage_Done
+};
+
+
+class CMovePicker
+{
+private:
+	const CPlayer & m_Player;
+	MovePickerStageType m_Stage;
+	CMove m_HashMove;
+	CMove m_aKillerMoves[cnNumKillerMoves];
+	int m_nNextKillerMove;
+	CMove m_CounterMove;
+	CMoveList & m_Moves;				// From the search's move stack.
+	int m_nNextMove;
+	bool m_bCapturesOnly;				// For the quiescence search.
+	CLegalityMasks m_LegalityMasks;
+
+	bool WasAlreadyPicked( const CMove & move ) const;
+	void ScoreCaptures( void );
+	void ScoreQuietMoves( void );
+	bool PickBestRemainingMove( CMove & move );
+
+public:
+	CMovePicker( const CPlayer & player, CMoveList & moveList, const CMove & hashMove,
+		const CMove kaKillerMoves[cnNumKillerMoves], const CMove & counterMove );
+	CMovePicker( const CPlayer & player, CMoveList & moveList, bool bCapturesOnly );
+	bool GetNextMove( CMove & move );
+}; // class CMovePicker
+
+
+CMovePicker::CMovePicker( const CPlayer & player, CMoveList & moveList, const CMove & hashMove,
+		const CMove kaKillerMoves[cnNumKillerMoves], const CMove & counterMove )
+	: m_Player( player ),
+		m_Stage( eMovePickerStage_HashMove ),
+		m_HashMove( hashMove ),
+		m_nNextKillerMove( 0 ),
+		m_CounterMove( counterMove ),
+		m_Moves( moveList ),
+		m_nNextMove( 0 ),
+		m_bCapturesOnly( false )
+{
+
+	for( int i = 0; i < cnNumKillerMoves; ++i )
+	{
+		m_aKillerMoves[i] = kaKillerMoves[i];
+	}
+
+	m_Player.GetLegalityMasks( m_LegalityMasks );
+}
+
+
+CMovePicker::CMovePicker( const CPlayer & player, CMoveList & moveList, bool bCapturesOnly )
+	: m_Player( player ),
+		m_Stage( eMovePickerStage_GenerateCaptures ),
+		m_nNextKillerMove( 0 ),
+		m_Moves( moveList ),
+		m_nNextMove( 0 ),
+		m_bCapturesOnly( bCapturesOnly )
+{
+	// For the quiescence search: hand out the captures and promotions only,
+	// or, to escape from check, all of the moves, without a hash move or killer moves.
+	m_Player.GetLegalityMasks( m_LegalityMasks );
+}
+
+
+bool CMovePicker::WasAlreadyPicked( const CMove & move ) const
+{
+	// Was the move handed out by the hash move, killer move or counter move stage?
+
+	if( move == m_HashMove  ||  ( m_Stage > eMovePickerStage_CounterMove  &&  move == m_CounterMove ) )
+	{
+		return( true );
+	}
+
+	for( int i = 0; i < m_nNextKillerMove; ++i )
+	{
+
+		if( move == m_aKillerMoves[i] )
+		{
+			return( true );
+		}
+	}
+
+	return( false );
+}
+
+
+void CMovePicker::ScoreCaptures( void )
+{
+	// Most valuable victim first; among captures of equal victims, least valuable attacker first.
+	const CGame & kGame = m_Player.m_Game;
+	const int knNumMoves = m_Moves.Size();
+
+	for( int i = 0; i < knNumMoves; ++i )
+	{
+		const CMove & kMove = m_Moves[i];
+		const PieceTypeType kMovingPieceType = kGame.GetPieceTypeOnSquare( m_Player.m_knSelfID, kMove.GetSrcSquare() );
+
+		// The piece types are listed from the king to the pawn, so a higher type is a less valuable attacker.
+		m_Moves.m_anScores[i] = m_Player.GetCaptureGain( kMove ) * eNumPieceTypes + kMovingPieceType;
+	}
+}
+
+
+void CMovePicker::ScoreQuietMoves( void )
+{
+	// The moves that have caused the most cutoffs elsewhere come first.
+	const int ( * const kaanHistory )[cnBoardArea] = m_Player.m_Game.m_aaanHistory[m_Player.m_knSelfID];
+	const int knNumMoves = m_Moves.Size();
+
+	for( int i = 0; i < knNumMoves; ++i )
+	{
+		m_Moves.m_anScores[i] = kaanHistory[m_Moves[i].GetSrcSquare()][m_Moves[i].GetDstSquare()];
+	}
+}
+
+
+bool CMovePicker::PickBestRemainingMove( CMove & move )
+{
+	// Select the best of the remaining moves; usually only the first few are needed.
+
+	if( m_nNextMove >= m_Moves.Size() )
+	{
+		return( false );
+	}
+
+	int nBest = m_nNextMove;
+
+	for( int i = m_nNextMove + 1; i < m_Moves.Size(); ++i )
+	{
+
+		if( m_Moves.m_anScores[i] > m_Moves.m_anScores[nBest] )
+		{
+			nBest = i;
+		}
+	}
+
+	swap( m_Moves.m_aMoves[nBest], m_Moves.m_aMoves[m_nNextMove] );
+	swap( m_Moves.m_anScores[nBest], m_Moves.m_anScores[m_nNextMove] );
+	move = m_Moves[m_nNextMove++];
+	return( true );
+}
+
+
+bool CMovePicker::GetNextMove( CMove & move )
+{
+	// Returns false when there are no moves left.
+
+	for( ;; )
+	{
+
+		switch( m_Stage )
+		{
+			case eMovePickerStage_HashMove:
+				m_Stage = eMovePickerStage_GenerateCaptures;
+
+				if( !( m_HashMove == CMove() )  &&  m_Player.IsMoveLegal( m_HashMove, m_LegalityMasks ) )
+				{
+					move = m_HashMove;
+					return( true );
+				}
+
+				m_HashMove = CMove();
+				break;
+
+			case eMovePickerStage_GenerateCaptures:
+				m_Player.GenerateMoves( m_Moves, eGenMoveType_Capturing, m_LegalityMasks );
+				ScoreCaptures();
+				m_nNextMove = 0;
+				m_Stage = eMovePickerStage_Captures;
+				break;
+
+			case eMovePickerStage_Captures:
+
+				while( PickBestRemainingMove( move ) )
+				{
+
+					if( !( move == m_HashMove ) )
+					{
+						return( true );
+					}
+				}
+
+				m_Stage = m_bCapturesOnly ? eMovePickerStage_Done : eMovePickerStage_Killers;
+				break;
+
+			case eMovePickerStage_Killers:
+
+				while( m_nNextKillerMove < cnNumKillerMoves )
+				{
+					move = m_aKillerMoves[m_nNextKillerMove];
+
+					if( move == CMove()  ||  WasAlreadyPicked( move )  ||
+							!m_Player.IsMoveLegal( move, m_LegalityMasks )  ||  m_Player.IsCaptureOrPromotion( move ) )
+					{
+						// Skip this killer move, and make sure that it isn't treated as already picked.
+						m_aKillerMoves[m_nNextKillerMove] = CMove();
+						++m_nNextKillerMove;
+						continue;
+					}
+
+					++m_nNextKillerMove;
+					return( true );
+				}
+
+				m_Stage = eMovePickerStage_CounterMove;
+				break;
+
+			case eMovePickerStage_CounterMove:
+
+				if( m_CounterMove == CMove()  ||  WasAlreadyPicked( m_CounterMove )  ||
+						!m_Player.IsMoveLegal( m_CounterMove, m_LegalityMasks )  ||  m_Player.IsCaptureOrPromotion( m_CounterMove ) )
+				{
+					// Make sure that the counter move isn't treated as already picked.
+					m_CounterMove = CMove();
+				}
+
+				m_Stage = eMovePickerStage_GenerateQuietMoves;
+
+				if( !( m_CounterMove == CMove() ) )
+				{
+					move = m_CounterMove;
+					return( true );
+				}
+
+				break;
+
+			case eMovePickerStage_GenerateQuietMoves:
+				m_Player.GenerateMoves( m_Moves, eGenMoveType_Quiet, m_LegalityMasks );
+				ScoreQuietMoves();
+				m_nNextMove = 0;
+				m_Stage = eMovePickerStage_QuietMoves;
+				break;
+
+			case eMovePickerStage_QuietMoves:
+
+				while( PickBestRemainingMove( move ) )
+				{
+
+					if( !WasAlreadyPicked( move ) )
+					{
+						return( true );
+					}
+				}
+
+				m_Stage = eMovePickerStage_Done;
+				break;
+
+			default:
+				return( false );
+		}
+	}
+}
+
+
+ScoreType CPlayer::FindBestMove( CMove * pBestMove, int nPly, int nMaxPly, ScoreType nAlpha, ScoreType nBeta )
+{
+	// Negamax: the value of a line is the negation of the value of the resulting
+	// position to the opponent; at the end of the line, it is the static
+	// evaluation, or the value of checkmate or stalemate.
+	// Only values inside the window ( nAlpha, nBeta ) need to be exact:
+	// a returned value <= nAlpha is an upper bound, and a returned
+	// value >= nBeta is a lower bound.
+	// nPly is the distance from the root; nMaxPly is the remaining depth.
+	CMoveList & bestMoves = m_Game.m_BestRootMoves;
+	CTranspositionTable * const kpTranspositionTable = m_Game.m_pTranspositionTable;
+	const HashKeyType knHashKey = m_Game.m_nHashKey;
+	const ScoreType knOriginalAlpha = nAlpha;
+	CTranspositionTableEntry entry;
+	CMove hashMove;
+
+	if( m_Game.m_bStopSearch )
+	{
+		// The budget has run out; the caller will discard this value.
+		return( 0 );
+	}
+
+	// The tablebases give the exact value of the endgames that they cover,
+	// and at the root, the best move too.
+	ScoreType nTablebaseValue = 0;
+
+	if( m_Game.ProbeTablebases( nPly, nTablebaseValue )  &&
+		( pBestMove == 0  ||  m_Game.FindTablebaseMove( *pBestMove, nTablebaseValue ) ) )
+	{
+		return( nTablebaseValue );
+	}
+
+	++m_Game.m_SearchStatistics.m_nNumTranspositionTableProbes;
+
+	if( kpTranspositionTable->Probe( knHashKey, entry ) )
+	{
+		++m_Game.m_SearchStatistics.m_nNumTranspositionTableHits;
+		hashMove = entry.GetMove();
+
+		// A result from a deep enough search may make this search unnecessary.
+		// At the root, we still need to search for the best move.
+
+		if( pBestMove == 0  &&  entry.GetDepth() >= nMaxPly )
+		{
+			const ScoreType knScore = ScoreFromTranspositionTable( entry.GetScore(), nPly );
+
+			if( entry.GetBound() == eBoundType_Exact  ||
+					( entry.GetBound() == eBoundType_Lower  &&  knScore >= nBeta )  ||
+					( entry.GetBound() == eBoundType_Upper  &&  knScore <= nAlpha ) )
+			{
+				return( knScore );
+			}
+		}
+	}
+
+	// Try the best move from the earlier search first, then the captures,
+	// then the killer moves and the counter move, then the other moves
+	// in order of their history, until:
+	// 1) The moves run out;
+	// 2) Alpha-Beta pruning terminates the search.
+	CMovePicker movePicker( *this, m_Game.m_MoveStack[nPly], hashMove, m_Game.m_aaKillerMoves[nPly], m_Game.GetCounterMove() );
+	ScoreType nBestLineValue = -cnInfiniteScore;
+	int nNumMovesSearched = 0;
+	CMove bestMove;
+	CMove currentMove;
+
+	if( pBestMove != 0 )
+	{
+		bestMoves.Clear();
+	}
+
+	while( movePicker.GetNextMove( currentMove ) )
+	{
+		// At the root, lines that tie the best line are wanted too,
+		// so the opponent's window is widened slightly to resolve them.
+		const ScoreType knTieMargin = pBestMove != 0 ? 1 : 0;
+		const PieceTypeType kCapturedPieceType = m_Game.MakeMove( currentMove );
+		ScoreType nLineValue = 0;
+
+		m_Game.CountSearchNode();
+		++nNumMovesSearched;
+
+		// Recurse if we're not too deep; at the end of the line, resolve the captures.
+
+		if( nMaxPly > 0 )
+		{
+			nLineValue = -m_Opponent.FindBestMove( 0, nPly + 1, nMaxPly - 1, -nBeta, -nAlpha + knTieMargin );
+		}
+		else
+		{
+			nLineValue = -m_Opponent.Quiesce( nPly + 1, -nBeta, -nAlpha + knTieMargin );
+		}
+
+		m_Game.UnmakeMove();
+
+		if( m_Game.m_bStopSearch )
+		{
+			// The search was interrupted, so nLineValue can't be trusted.
+			return( 0 );
+		}
+
+		// Record the move, if it's a best move.
+
+		if( nLineValue > nBestLineValue )
+		{
+			nBestLineValue = nLineValue;
+			bestMove = currentMove;
+
+			if( pBestMove != 0 )
+			{
+				bestMoves.Clear();
+			}
+		}
+
+		if( pBestMove != 0  &&  nLineValue >= nBestLineValue )
+		{
+			bestMoves.Add( currentMove );
+		}
+
+		// Do any pruning.
+
+		if( nBestLineValue > nAlpha )
+		{
+			nAlpha = nBestLineValue;
+		}
+
+		if( nAlpha >= nBeta )
+		{
+			++m_Game.m_SearchStatistics.m_nNumFailHighs;
+
+			if( nNumMovesSearched == 1 )
+			{
+				++m_Game.m_SearchStatistics.m_nNumFailHighsOnFirstMove;
+			}
+
+			if( kCapturedPieceType == ePieceType_Null  &&  !currentMove.IsPromotion() )
+			{
+				m_Game.RecordQuietCutoff( nPly, nMaxPly + 1, currentMove );
+			}
+
+			break;
+		}
+	}
+
+	if( nNumMovesSearched == 0 )
+	{
+		// The player has no legal moves: checkmate or stalemate.
+		nBestLineValue = IsInCheck() ? -( cnMateScore - nPly ) : 0;
+	}
+
+	// Remember the result, and how far it can be trusted.
+	BoundType Bound = eBoundType_Exact;
+
+	if( nBestLineValue <= knOriginalAlpha )
+	{
+		Bound = eBoundType_Upper;
+	}
+	else if( nBestLineValue >= nBeta )
+	{
+		Bound = eBoundType_Lower;
+	}
+
+	kpTranspositionTable->Store( knHashKey, ScoreToTranspositionTable( nBestLineValue, nPly ), bestMove, nMaxPly, Bound );
+
+	if( pBestMove != 0  &&  !bestMoves.IsEmpty() )
+	{
+		*pBestMove = bestMoves[m_Game.m_RandomNumberGenerator.GetNextBelow( bestMoves.Size() )];
+	}
+
+	return( nBestLineValue );
+}
+
+
+ScoreType CPlayer::Quiesce( int nPly, ScoreType nAlpha, ScoreType nBeta )
+{
+	// The quiescence search: at the end of the line, play out the captures
+	// and promotions, so that the static evaluation is only applied to quiet
+	// positions.  The player to move may instead "stand pat" on the static
+	// evaluation, since a player is never obliged to capture; but a player
+	// who is in check must find a way out of it.
+	const ScoreType knStandPatValue = m_Game.Evaluate();
+	const bool kbInCheck = IsInCheck();
+
+	if( m_Game.m_bStopSearch )
+	{
+		// The budget has run out; the caller will discard this value.
+		return( 0 );
+	}
+
+	if( nPly >= cnMaxSearchPly - 1  ||  ( !kbInCheck  &&  knStandPatValue >= nBeta ) )
+	{
+		return( knStandPatValue );
+	}
+
+	if( !kbInCheck  &&  knStandPatValue > nAlpha )
+	{
+		nAlpha = knStandPatValue;
+	}
+
+	CMovePicker movePicker( *this, m_Game.m_MoveStack[nPly], !kbInCheck );
+	ScoreType nBestLineValue = kbInCheck ? -( cnMateScore - nPly ) : knStandPatValue;
+	CMove currentMove;
+
+	while( movePicker.GetNextMove( currentMove ) )
+	{
+
+		if( kbInCheck )
+		{
+			// Every way out of check is searched.
+		}
+		else if( currentMove.IsPromotion()  &&  currentMove.GetPromotedTo() != ePieceType_Queen )
+		{
+			// An underpromotion is rarely better than a promotion to a queen.
+			continue;
+		}
+		else if( knStandPatValue + GetCaptureGain( currentMove ) + cnDeltaPruningMargin <= nAlpha  ||
+				GetStaticExchangeValue( currentMove ) < 0 )
+		{
+			// Delta pruning: skip a capture that can't raise the value to alpha,
+			// even with a generous allowance for the change in piece placement.
+			// Also skip a capture that loses material once the recaptures are played out.
+			continue;
+		}
+
+		ScoreType nLineValue = 0;
+
+		m_Game.MakeMove( currentMove );
+		m_Game.CountSearchNode();
+		++m_Game.m_SearchStatistics.m_nNumQuiescenceNodes;
+		nLineValue = -m_Opponent.Quiesce( nPly + 1, -nBeta, -nAlpha );
+		m_Game.UnmakeMove();
+
+		if( m_Game.m_bStopSearch )
+		{
+			return( 0 );
+		}
+
+		if( nLineValue > nBestLineValue )
+		{
+			nBestLineValue = nLineValue;
+
+			if( nBestLineValue > nAlpha )
+			{
+				nAlpha = nBestLineValue;
+			}
+
+			if( nAlpha >= nBeta )
+			{
+				break;
+			}
+		}
+	}
+
+	return( nBestLineValue );
+}
+
+
+unsigned long long CPlayer::Perft( int nDepth )
+{
+	// Count the legal move sequences of the given length (the leaf nodes of the move tree).
+
+	if( nDepth <= 0 )
+	{
+		return( 1 );
+	}
+
+	CMoveList generatedMoves;
+	unsigned long long nNumLeafNodes = 0;
+
+	GenerateMoves( generatedMoves, eGenMoveType_All );
+
+	const int knNumGeneratedMoves = generatedMoves.Size();
+
+	if( nDepth == 1 )
+	{
+		// The moves are legal, so the last ply needn't be made.
+		return( knNumGeneratedMoves );
+	}
+
+	for( int i = 0; i < knNumGeneratedMoves; ++i )
+	{
+		m_Game.MakeMove( generatedMoves[i] );
+		nNumLeafNodes += m_Opponent.Perft( nDepth - 1 );
+		m_Game.UnmakeMove();
+	}
+
+	return( nNumLeafNodes );
+}
+
+
+CGame::CGame( int nTranspositionTableSizeInMB )
+	: m_WhitePlayer( 0, *this, m_BlackPlayer ),
+		m_BlackPlayer( 1, *this, m_WhitePlayer ),
+		m_nPlayerToMove( 0 ),
+		m_nCastlingRights( eCastlingRights_All ),
+		m_nPawnCapturableViaEnPassant( -1 ),
+		m_nHalfMoveClock( 0 ),
+		m_nFullMoveNumber( 1 ),
+		m_nHashKey( 0 ),
+		m_nNumUndoRecords( 0 ),
+		m_pTranspositionTable( new CTranspositionTable( nTranspositionTableSizeInMB ) ),
+		m_pTablebases( new CTablebases ),
+		m_nNumSearchThreads( 1 ),
+		m_bEnforceSearchLimits( false ),
+		m_bStopSearch( false ),
+		m_bStopRequested( false ),
+		m_nNumSearchNodes( 0 ),
+		m_pMainThreadGame( 0 ),
+		m_nNumHelperSearchNodes( 0 ),
+		m_MoveStack( cnMaxSearchPly ),
+		m_RandomNumberGenerator( (unsigned long long)time( 0 ) )
+{
+	InitializeBoard();
+}
+
+
+CGame::CGame( const CGame & Src )
+	: m_WhitePlayer( 0, *this, m_BlackPlayer ),
+		m_BlackPlayer( 1, *this, m_WhitePlayer ),
+		m_nPlayerToMove( Src.m_nPlayerToMove ),
+		m_nCastlingRights( Src.m_nCastlingRights ),
+		m_nPawnCapturableViaEnPassant( Src.m_nPawnCapturableViaEnPassant ),
+		m_nHalfMoveClock( Src.m_nHalfMoveClock ),
+		m_nFullMoveNumber( Src.m_nFullMoveNumber ),
+		m_nHashKey( Src.m_nHashKey ),
+		m_nNumUndoRecords( Src.m_nNumUndoRecords ),
+		m_pTranspositionTable( Src.m_pTranspositionTable ),	// The copy shares the transposition table,
+		m_pTablebases( Src.m_pTablebases ),					// and the tablebases.
+		m_nNumSearchThreads( 1 ),
+		m_SearchLimits( Src.m_SearchLimits ),
+		m_bEnforceSearchLimits( false ),
+		m_bStopSearch( false ),
+		m_bStopRequested( false ),
+		m_nNumSearchNodes( 0 ),
+		m_pMainThreadGame( 0 ),
+		m_nNumHelperSearchNodes( 0 ),
+		m_SearchStartTime( Src.m_SearchStartTime ),
+		m_MoveStack( cnMaxSearchPly ),
+		m_RandomNumberGenerator( Src.m_RandomNumberGenerator )
+{
+	// Copy the position.  The players must refer to this game, not to Src.
+	memcpy( m_abbPieces, Src.m_abbPieces, sizeof( m_abbPieces ) );
+	memcpy( m_abbPlayerOccupancy, Src.m_abbPlayerOccupancy, sizeof( m_abbPlayerOccupancy ) );
+	m_bbOccupancy = Src.m_bbOccupancy;
+	memcpy( m_anMaterialValues, Src.m_anMaterialValues, sizeof( m_anMaterialValues ) );
+	memcpy( m_anPieceSquareValues, Src.m_anPieceSquareValues, sizeof( m_anPieceSquareValues ) );
+	memcpy( m_aUndoRecords, Src.m_aUndoRecords, m_nNumUndoRecords * sizeof( CUndoRecord ) );
+}
+
+
+void CGame::ClearBoard( void )
+{
+
+	for( int i = 0; i < 2; ++i )
+	{
+
+		for( int j = 0; j < eNumPieceTypes; ++j )
+		{
+			m_abbPieces[i][j] = 0;
+		}
+
+		m_abbPlayerOccupancy[i] = 0;
+	}
+
+	m_bbOccupancy = 0;
+	m_anMaterialValues[0] = 0;
+	m_anMaterialValues[1] = 0;
+	m_anPieceSquareValues[0] = 0;
+	m_anPieceSquareValues[1] = 0;
+	m_nPlayerToMove = 0;
+	m_nCastlingRights = 0;
+	m_nPawnCapturableViaEnPassant = -1;
+	m_nHalfMoveClock = 0;
+	m_nFullMoveNumber = 1;
+	m_nHashKey = 0;
+	m_nNumUndoRecords = 0;
+}
+
+
+void CGame::InitializeBoard( void )
+{
+	ClearBoard();
+
+	m_WhitePlayer.CreatePieces();
+	m_BlackPlayer.CreatePieces();
+
+	m_nCastlingRights = eCastlingRights_All;
+	m_nHashKey = ComputeHashKey();
+}
+
+
+void CGame::LoadFEN( const char * pcFEN ) throw( CException )
+{
+	// If the FEN string is invalid, the game is left in the initial position,
+	// rather than in a position that the search can't handle.
+
+	try
+	{
+		ParseFEN( pcFEN );
+	}
+	catch( ... )
+	{
+		InitializeBoard();
+		throw;
+	}
+}
+
+
+void CGame::ParseFEN( const char * pcFEN ) throw( CException )
+{
+	// Set up the position described by a FEN string: the board (row 7 first),
+	// the player to move, the castling flags, the en passant target square,
+	// and the half-move clock and the full move number.  The move counters
+	// may be left out, as they are in EPD, and whatever follows them is ignored.
+	const char * pc = pcFEN;
+	int nRow = 7;
+	int nCol = 0;
+
+	ClearBoard();
+
+	for( ; *pc != '\0'  &&  *pc != ' '; ++pc )
+	{
+
+		if( *pc == '/' )
+		{
+
+			if( nCol != 8  ||  nRow == 0 )
+			{
+				ThrowException( eStatus_InvalidParameter );
+			}
+
+			--nRow;
+			nCol = 0;
+		}
+		else if( *pc >= '1'  &&  *pc <= '8' )
+		{
+			nCol += *pc - '0';
+		}
+		else
+		{
+			const char kcUpper = ( *pc >= 'a'  &&  *pc <= 'z' ) ? *pc - ( 'a' - 'A' ) : *pc;
+			int nPieceType = ePieceType_King;
+
+			while( nPieceType < eNumPieceTypes  &&  caPieceArchetypes[nPieceType].m_Printable != kcUpper )
+			{
+				++nPieceType;
+			}
+
+			if( nPieceType == eNumPieceTypes  ||  nCol >= 8 )
+			{
+				ThrowException( eStatus_InvalidParameter );
+			}
+
+			AddPiece( kcUpper == *pc ? 0 : 1, (PieceTypeType)nPieceType, nRow * 8 + nCol );
+			++nCol;
+		}
+
+		if( nCol > 8 )
+		{
+			ThrowException( eStatus_InvalidParameter );
+		}
+	}
+
+	// The move generator relies on each player having one king, and on no pawn
+	// standing on the first or last row.
+
+	if( nRow != 0  ||  nCol != 8  ||
+			PopCount( m_abbPieces[0][ePieceType_King] ) != 1  ||
+			PopCount( m_abbPieces[1][ePieceType_King] ) != 1  ||
+			( ( m_abbPieces[0][ePieceType_Pawn] | m_abbPieces[1][ePieceType_Pawn] ) & 0xFF000000000000FFULL ) != 0 )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	// The player to move.
+
+	while( *pc == ' ' )
+	{
+		++pc;
+	}
+
+	if( *pc == 'b' )
+	{
+		m_nPlayerToMove = 1;
+	}
+	else if( *pc != 'w' )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	// The player who has just moved can't have left their king in check.
+
+	if( IsSquareAttacked( BitScanForward( m_abbPieces[1 - m_nPlayerToMove][ePieceType_King] ), m_nPlayerToMove ) )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	++pc;
+
+	// The castling flags.  A flag is only set if the king and rook are in place.
+
+	while( *pc == ' ' )
+	{
+		++pc;
+	}
+
+	for( ; *pc != '\0'  &&  *pc != ' '; ++pc )
+	{
+		const int knPlayerID = ( *pc == 'k'  ||  *pc == 'q' ) ? 1 : 0;
+		const int knBackRow = 7 * knPlayerID;
+		const bool kbKingInPlace = ( m_abbPieces[knPlayerID][ePieceType_King] & SquareToBitboard( knBackRow * 8 + 4 ) ) != 0;
+
+		switch( *pc )
+		{
+			case 'K':
+			case 'k':
+				if( kbKingInPlace  &&  ( m_abbPieces[knPlayerID][ePieceType_Rook] & SquareToBitboard( knBackRow * 8 + 7 ) ) != 0 )
+				{
+					m_nCastlingRights |= GetCastlingRight( knPlayerID, true );
+				}
+
+				break;
+
+			case 'Q':
+			case 'q':
+				if( kbKingInPlace  &&  ( m_abbPieces[knPlayerID][ePieceType_Rook] & SquareToBitboard( knBackRow * 8 + 0 ) ) != 0 )
+				{
+					m_nCastlingRights |= GetCastlingRight( knPlayerID, false );
+				}
+
+				break;
+
+			case '-':
+				break;
+
+			default:
+				ThrowException( eStatus_InvalidParameter );
+		}
+	}
+
+	// The en passant target square is the square that the pawn skipped over.
+
+	while( *pc == ' ' )
+	{
+		++pc;
+	}
+
+	if( *pc >= 'a'  &&  *pc <= 'h'  &&  ( pc[1] == '3'  ||  pc[1] == '6' ) )
+	{
+		const int knPawnRow = pc[1] == '3' ? 3 : 4;
+		const int knPawnSquare = knPawnRow * 8 + ( *pc - 'a' );
+
+		// Ignore the square unless the pawn that just moved is there.
+
+		if( ( m_abbPieces[1 - m_nPlayerToMove][ePieceType_Pawn] & SquareToBitboard( knPawnSquare ) ) != 0 )
+		{
+			m_nPawnCapturableViaEnPassant = knPawnSquare;
+		}
+	}
+	else if( *pc != '-'  &&  *pc != '\0' )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	// The move counters.
+
+	while( *pc != '\0'  &&  *pc != ' ' )
+	{
+		++pc;
+	}
+
+	while( *pc == ' ' )
+	{
+		++pc;
+	}
+
+	if( *pc >= '0'  &&  *pc <= '9' )
+	{
+		m_nHalfMoveClock = atoi( pc );
+
+		while( *pc >= '0'  &&  *pc <= '9' )
+		{
+			++pc;
+		}
+
+		while( *pc == ' ' )
+		{
+			++pc;
+		}
+
+		if( *pc >= '0'  &&  *pc <= '9' )
+		{
+			m_nFullMoveNumber = max( 1, atoi( pc ) );
+		}
+	}
+
+	m_nHashKey = ComputeHashKey();
+}
+
+
+string CGame::ToFEN( void ) const
+{
+	// The inverse of LoadFEN().
+	string strFEN;
+
+	for( int nRow = 7; nRow >= 0; --nRow )
+	{
+		int nNumEmptySquares = 0;
+
+		for( int nCol = 0; nCol < 8; ++nCol )
+		{
+			const int knSquare = nRow * 8 + nCol;
+			const int knPlayerID = ( m_abbPlayerOccupancy[0] & SquareToBitboard( knSquare ) ) != 0 ? 0 : 1;
+			const PieceTypeType kPieceType = GetPieceTypeOnSquare( knPlayerID, knSquare );
+
+			if( kPieceType == ePieceType_Null )
+			{
+				++nNumEmptySquares;
+				continue;
+			}
+
+			if( nNumEmptySquares > 0 )
+			{
+				strFEN += (char)( '0' + nNumEmptySquares );
+				nNumEmptySquares = 0;
+			}
+
+			strFEN += (char)( caPieceArchetypes[kPieceType].m_Printable + ( knPlayerID == 0 ? 0 : 'a' - 'A' ) );
+		}
+
+		if( nNumEmptySquares > 0 )
+		{
+			strFEN += (char)( '0' + nNumEmptySquares );
+		}
+
+		if( nRow > 0 )
+		{
+			strFEN += '/';
+		}
+	}
+
+	strFEN += m_nPlayerToMove == 0 ? " w " : " b ";
+
+	if( m_nCastlingRights == 0 )
+	{
+		strFEN += '-';
+	}
+	else
+	{
+		const char * const kpcCastlingFlags = "KQkq";
+
+		for( int i = 0; i < 4; ++i )
+		{
+
+			if( ( m_nCastlingRights & GetCastlingRight( i / 2, i % 2 == 0 ) ) != 0 )
+			{
+				strFEN += kpcCastlingFlags[i];
+			}
+		}
+	}
+
+	strFEN += ' ';
+
+	if( m_nPawnCapturableViaEnPassant >= 0 )
+	{
+		// The square that the pawn skipped over.
+		const int knTargetSquare = m_nPawnCapturableViaEnPassant + ( m_nPlayerToMove == 0 ? 8 : -8 );
+
+		strFEN += (char)( 'a' + knTargetSquare % 8 );
+		strFEN += (char)( '1' + knTargetSquare / 8 );
+	}
+	else
+	{
+		strFEN += '-';
+	}
+
+	return( strFEN + " " + to_string( m_nHalfMoveClock ) + " " + to_string( m_nFullMoveNumber ) );
+}
+
+
+string CGame::MoveToString( const CMove & move ) const
+{
+	// Coordinate notation, eg. "e2e4", "e7e8q".  Castling is written as the king's move.
+	const int knSrcSquare = move.GetSrcSquare();
+	const int knDstSquare = move.GetDstSquare();
+	string strMove;
+
+	strMove += (char)( 'a' + knSrcSquare % 8 );
+	strMove += (char)( '1' + knSrcSquare / 8 );
+	strMove += (char)( 'a' + knDstSquare % 8 );
+	strMove += (char)( '1' + knDstSquare / 8 );
+
+	if( move.IsPromotion() )
+	{
+		strMove += (char)( caPieceArchetypes[move.GetPromotedTo()].m_Printable + ( 'a' - 'A' ) );
+	}
+
+	return( strMove );
+}
+
+
+string CGame::MoveToSAN( const CMove & move )
+{
+	// Standard algebraic notation, eg. "Nbd7", "exd5", "e8=Q", "O-O",
+	// without a check or checkmate suffix.  The move must be legal.
+	const int knSrcSquare = move.GetSrcSquare();
+	const int knDstSquare = move.GetDstSquare();
+
+	if( move.IsCastling() )
+	{
+		return( knDstSquare % 8 == 6 ? "O-O" : "O-O-O" );
+	}
+
+	const PieceTypeType kPieceType = GetPieceTypeOnSquare( m_nPlayerToMove, knSrcSquare );
+	const bool kbIsCapture = move.IsEnPassant()  ||  ( m_abbPlayerOccupancy[1 - m_nPlayerToMove] & SquareToBitboard( knDstSquare ) ) != 0;
+	string strSAN;
+
+	if( kPieceType == ePieceType_Pawn )
+	{
+
+		if( kbIsCapture )
+		{
+			strSAN += (char)( 'a' + knSrcSquare % 8 );
+		}
+	}
+	else
+	{
+		// If another piece of the type can move to the same square, name the
+		// moving piece's column, or if that is shared, its row, or else both.
+		CMoveList generatedMoves;
+		bool bIsAmbiguous = false;
+		bool bColIsShared = false;
+		bool bRowIsShared = false;
+
+		strSAN += caPieceArchetypes[kPieceType].m_Printable;
+		GetPlayerToMove().GenerateMoves( generatedMoves, eGenMoveType_All );
+
+		for( int i = 0; i < generatedMoves.Size(); ++i )
+		{
+			const int knOtherSrcSquare = generatedMoves[i].GetSrcSquare();
+
+			if( generatedMoves[i].GetDstSquare() == knDstSquare  &&  knOtherSrcSquare != knSrcSquare  &&
+				GetPieceTypeOnSquare( m_nPlayerToMove, knOtherSrcSquare ) == kPieceType )
+			{
+				bIsAmbiguous = true;
+				bColIsShared = bColIsShared  ||  knOtherSrcSquare % 8 == knSrcSquare % 8;
+				bRowIsShared = bRowIsShared  ||  knOtherSrcSquare / 8 == knSrcSquare / 8;
+			}
+		}
+
+		if( bIsAmbiguous  &&  ( !bColIsShared  ||  bRowIsShared ) )
+		{
+			strSAN += (char)( 'a' + knSrcSquare % 8 );
+		}
+
+		if( bColIsShared )
+		{
+			strSAN += (char)( '1' + knSrcSquare / 8 );
+		}
+	}
+
+	if( kbIsCapture )
+	{
+		strSAN += 'x';
+	}
+
+	strSAN += (char)( 'a' + knDstSquare % 8 );
+	strSAN += (char)( '1' + knDstSquare / 8 );
+
+	if( move.IsPromotion() )
+	{
+		strSAN += '=';
+		strSAN += caPieceArchetypes[move.GetPromotedTo()].m_Printable;
+	}
+
+	return( strSAN );
+}
+
+
+CMove CGame::StringToMove( const string & strMove )
+{
+	// The inverse of MoveToString(): find the legal move written as strMove,
+	// or return CMove() if there is none.
+	CMoveList generatedMoves;
+
+	GetPlayerToMove().GenerateMoves( generatedMoves, eGenMoveType_All );
+
+	for( int i = 0; i < generatedMoves.Size(); ++i )
+	{
+
+		if( MoveToString( generatedMoves[i] ) == strMove )
+		{
+			return( generatedMoves[i] );
+		}
+	}
+
+	return( CMove() );
+}
+
+
+CMove CGame::ProbeOpeningBook( const COpeningBook & book )
+{
+	// Choose a move for the position from the book, or return CMove() if it
+	// has none.  The move is checked against the legal moves, in case the
+	// position's key belongs to another position too.
+	int nSrcSquare = 0;
+	int nDstSquare = 0;
+	PieceTypeType PromotedTo = ePieceType_Null;
+
+	if( !book.Probe( ComputePolyglotKey(), m_RandomNumberGenerator, nSrcSquare, nDstSquare, PromotedTo ) )
+	{
+		return( CMove() );
+	}
+
+	// The book writes castling as the king's move to the rook's square.
+
+	if( ( m_abbPieces[m_nPlayerToMove][ePieceType_King] & SquareToBitboard( nSrcSquare ) ) != 0  &&
+		nSrcSquare / 8 == nDstSquare / 8  &&  abs( nDstSquare - nSrcSquare ) > 1 )
+	{
+		nDstSquare = nSrcSquare + ( nDstSquare > nSrcSquare ? 2 : -2 );
+	}
+
+	CMoveList generatedMoves;
+
+	GetPlayerToMove().GenerateMoves( generatedMoves, eGenMoveType_All );
+
+	for( int i = 0; i < generatedMoves.Size(); ++i )
+	{
+		const CMove & kMove = generatedMoves[i];
+
+		if( kMove.GetSrcSquare() == nSrcSquare  &&  kMove.GetDstSquare() == nDstSquare  &&
+			( kMove.IsPromotion() ? kMove.GetPromotedTo() : ePieceType_Null ) == PromotedTo )
+		{
+			return( kMove );
+		}
+	}
+
+	return( CMove() );
+}
+
+
+bool CGame::IsGameOver( GameResultType & result, string & strReason )
+{
+	// Decide whether the game has ended, by the rules rather than by adjudication.
+	CMoveList generatedMoves;
+
+	GetPlayerToMove().GenerateMoves( generatedMoves, eGenMoveType_All );
+
+	if( generatedMoves.IsEmpty() )
+	{
+
+		if( GetPlayerToMove().IsInCheck() )
+		{
+			result = m_nPlayerToMove == 0 ? eGameResult_BlackWins : eGameResult_WhiteWins;
+			strReason = "checkmate";
+		}
+		else
+		{
+			result = eGameResult_Draw;
+			strReason = "stalemate";
+		}
+
+		return( true );
+	}
+
+	result = eGameResult_Draw;
+
+	if( m_nHalfMoveClock >= 100 )
+	{
+		strReason = "fifty-move rule";
+	}
+	else if( CountRepetitions() >= 2 )
+	{
+		strReason = "threefold repetition";
+	}
+	else if( HasInsufficientMaterial() )
+	{
+		strReason = "insufficient material";
+	}
+	else
+	{
+		return( false );
+	}
+
+	return( true );
+}
+
+
+bool CGame::GetTablebaseIndex( int & nMaterialKey, unsigned long long & nIndex ) const
+{
+	// Find the position's table and its index in the table; see "Endgame tablebases".
+	// Returns false if the position has too many pieces.
+	int aanPieceCounts[2][eNumPieceTypes];
+	int nStrongerPlayerID = 0;
+
+	if( PopCount( m_bbOccupancy ) > cnMaxNumTablebasePieces )
+	{
+		return( false );
+	}
+
+	for( int i = 0; i < 2; ++i )
+	{
+
+		for( int j = 0; j < eNumPieceTypes; ++j )
+		{
+			aanPieceCounts[i][j] = PopCount( m_abbPieces[i][j] );
+		}
+	}
+
+	nMaterialKey = MakeTablebaseMaterialKey( aanPieceCounts, nStrongerPlayerID );
+	nIndex = m_nPlayerToMove == nStrongerPlayerID ? 0 : 1;
+
+	for( int nSide = 0; nSide < 2; ++nSide )
+	{
+		const int knPlayerID = nSide == 0 ? nStrongerPlayerID : 1 - nStrongerPlayerID;
+
+		for( int j = 0; j < eNumPieceTypes; ++j )
+		{
+			// If Black is the stronger side, flip the board, so that Black's pieces play as White's.
+			BitboardType bb = nStrongerPlayerID == 0 ? m_abbPieces[knPlayerID][j] : FlipBitboardVertically( m_abbPieces[knPlayerID][j] );
+
+			while( bb != 0 )
+			{
+				nIndex = nIndex * cnBoardArea + PopLowestBit( bb );
+			}
+		}
+	}
+
+	return( true );
+}
+
+
+bool CGame::SetUpTablebasePosition( int nMaterialKey, unsigned long long nIndex )
+{
+	// The inverse of GetTablebaseIndex(), with the stronger side as White.
+	// Returns false if the index doesn't describe a legal position.
+	PieceTypeType aPieceTypes[cnMaxNumTablebasePieces];
+	int anPlayerIDs[cnMaxNumTablebasePieces];
+	int anSquares[cnMaxNumTablebasePieces];
+	int nNumPieces = 0;
+
+	for( int nSide = 0; nSide < 2; ++nSide )
+	{
+
+		for( int j = 0; j < eNumPieceTypes; ++j )
+		{
+			const int knCount = j == ePieceType_King ? 1 : GetTablebasePieceCount( nMaterialKey, nSide, j );
+
+			for( int k = 0; k < knCount; ++k )
+			{
+				aPieceTypes[nNumPieces] = (PieceTypeType)j;
+				anPlayerIDs[nNumPieces] = nSide;
+				++nNumPieces;
+			}
+		}
+	}
+
+	for( int i = nNumPieces - 1; i >= 0; --i )
+	{
+		anSquares[i] = (int)( nIndex % cnBoardArea );
+		nIndex /= cnBoardArea;
+	}
+
+	ClearBoard();
+	m_nPlayerToMove = (int)nIndex;
+
+	for( int i = 0; i < nNumPieces; ++i )
+	{
+		const int knSquare = anSquares[i];
+		const int knRow = knSquare / 8;
+
+		// Pieces can't share a square, pawns can't stand on the first or last row,
+		// and pieces of a type are in ascending order, so that each position has one index.
+
+		if( ( m_bbOccupancy & SquareToBitboard( knSquare ) ) != 0  ||
+			( aPieceTypes[i] == ePieceType_Pawn  &&  ( knRow == 0  ||  knRow == 7 ) )  ||
+			( i > 0  &&  aPieceTypes[i] == aPieceTypes[i - 1]  &&  anPlayerIDs[i] == anPlayerIDs[i - 1]  &&  knSquare < anSquares[i - 1] ) )
+		{
+			return( false );
+		}
+
+		AddPiece( anPlayerIDs[i], aPieceTypes[i], knSquare );
+	}
+
+	// The player who has just moved can't be in check.
+	const int knOpponentID = 1 - m_nPlayerToMove;
+
+	return( !IsSquareAttacked( BitScanForward( m_abbPieces[knOpponentID][ePieceType_King] ), m_nPlayerToMove ) );
+}
+
+
+unsigned char CGame::GetTablebaseEntry( void ) const
+{
+	// The position's entry in its table, or cnTablebaseUnknown if the table isn't available.
+	// The position is assumed to have no castling rights.
+	int nMaterialKey = 0;
+	unsigned long long nIndex = 0;
+
+	if( PopCount( m_bbOccupancy ) == 2 )
+	{
+		// Bare kings.
+		return( cnTablebaseDraw );
+	}
+
+	if( !GetTablebaseIndex( nMaterialKey, nIndex ) )
+	{
+		return( cnTablebaseUnknown );
+	}
+
+	const unsigned char * const kpcTable = m_pTablebases->GetTable( nMaterialKey );
+
+	return( kpcTable != 0 ? kpcTable[nIndex] : cnTablebaseUnknown );
+}
+
+
+bool CGame::CanCaptureEnPassant( void ) const
+{
+	// True if a pawn of the player to move stands beside a pawn that can be captured en passant.
+	// The capture might still be illegal.
+
+	if( m_nPawnCapturableViaEnPassant < 0 )
+	{
+		return( false );
+	}
+
+	const int knCol = m_nPawnCapturableViaEnPassant % 8;
+	BitboardType bbCapturingSquares = 0;
+
+	if( knCol > 0 )
+	{
+		bbCapturingSquares |= SquareToBitboard( m_nPawnCapturableViaEnPassant - 1 );
+	}
+
+	if( knCol < 7 )
+	{
+		bbCapturingSquares |= SquareToBitboard( m_nPawnCapturableViaEnPassant + 1 );
+	}
+
+	return( ( bbCapturingSquares & m_abbPieces[m_nPlayerToMove][ePieceType_Pawn] ) != 0 );
+}
+
+
+unsigned char CGame::GetTablebaseEntryAllowingEnPassant( void )
+{
+	// The position's entry, as GetTablebaseEntry(), but allowing for an en passant
+	// capture, which the tables don't cover: when one may be possible, the entry is
+	// worked out from those of the positions after each move.  This only recurses
+	// through double pawn moves, so it soon ends.
+
+	if( !CanCaptureEnPassant() )
+	{
+		return( GetTablebaseEntry() );
+	}
+
+	CMoveList generatedMoves;
+	unsigned char nWinEntry = cnTablebaseUnknown;		// The fastest win found, if any.
+	unsigned char nLossEntry = cnTablebaseDraw;		// The slowest loss, if every move loses.
+	bool bEveryMoveLoses = true;
+	bool bSomeMoveIsUnknown = false;
+
+	GetPlayerToMove().GenerateMoves( generatedMoves, eGenMoveType_All );
+
+	if( generatedMoves.IsEmpty() )
+	{
+		return( GetPlayerToMove().IsInCheck() ? 1 : cnTablebaseDraw );
+	}
+
+	for( int i = 0; i < generatedMoves.Size(); ++i )
+	{
+		MakeMove( generatedMoves[i] );
+
+		const unsigned char knEntry = GetTablebaseEntryAllowingEnPassant();
+
+		UnmakeMove();
+
+		if( knEntry == cnTablebaseUnknown  ||  knEntry == cnTablebaseDraw )
+		{
+			bSomeMoveIsUnknown = bSomeMoveIsUnknown  ||  knEntry == cnTablebaseUnknown;
+			bEveryMoveLoses = false;
+		}
+		else if( ( knEntry - 1 ) % 2 == 0 )
+		{
+			// The opponent is mated in an even number of plies.
+			nWinEntry = min( nWinEntry, (unsigned char)( knEntry + 1 ) );
+			bEveryMoveLoses = false;
+		}
+		else
+		{
+			nLossEntry = max( nLossEntry, (unsigned char)( knEntry + 1 ) );
+		}
+	}
+
+	if( nWinEntry != cnTablebaseUnknown )
+	{
+		return( nWinEntry );
+	}
+	else if( bSomeMoveIsUnknown )
+	{
+		return( cnTablebaseUnknown );
+	}
+
+	return( bEveryMoveLoses ? nLossEntry : cnTablebaseDraw );
+}
+
+
+bool CGame::ProbeTablebases( int nPly, ScoreType & nScore ) const
+{
+	// The value of the position, at nPly from the root, from the tablebases.
+	// Returns false if they don't cover the position.
+
+	if( PopCount( m_bbOccupancy ) > m_pTablebases->GetMaxNumPieces()  ||  m_nCastlingRights != 0 )
+	{
+		return( false );
+	}
+
+	if( CanCaptureEnPassant() )
+	{
+		// The tables don't cover en passant captures, so there must be none to make.
+		return( false );
+	}
+
+	const unsigned char knEntry = GetTablebaseEntry();
+
+	if( knEntry == cnTablebaseUnknown )
+	{
+		return( false );
+	}
+
+	if( knEntry == cnTablebaseDraw )
+	{
+		nScore = 0;
+	}
+	else
+	{
+		const int knPliesToMate = knEntry - 1;
+
+		nScore = cnMateScore - ( nPly + knPliesToMate );
+
+		if( knPliesToMate % 2 == 0 )
+		{
+			nScore = -nScore;
+		}
+	}
+
+	return( true );
+}
+
+
+bool CGame::FindTablebaseMove( CMove & bestMove, ScoreType & nBestLineValue )
+{
+	// At the root: choose the move to the position with the best tablebase value.
+	// Returns false if the tablebases don't cover the positions after all of the moves.
+	CMoveList generatedMoves;
+
+	GetPlayerToMove().GenerateMoves( generatedMoves, eGenMoveType_All );
+	bestMove = CMove();
+	nBestLineValue = -cnInfiniteScore;
+
+	for( int i = 0; i < generatedMoves.Size(); ++i )
+	{
+		ScoreType nLineValue = 0;
+
+		MakeMove( generatedMoves[i] );
+
+		const bool kbCovered = ProbeTablebases( 1, nLineValue );
+
+		UnmakeMove();
+
+		if( !kbCovered )
+		{
+			bestMove = CMove();
+			return( false );
+		}
+
+		if( -nLineValue > nBestLineValue )
+		{
+			nBestLineValue = -nLineValue;
+			bestMove = generatedMoves[i];
+		}
+	}
+
+	return( !( bestMove == CMove() ) );
+}
+
+
+void CGame::RunTablebasePass( int nMaterialKey, unsigned char * pcTable, int nPass,
+	unsigned long long nBeginIndex, unsigned long long nEndIndex, vector<unsigned long long> * pResolvedIndices )
+{
+	// The body of a tablebase generator thread: one pass over part of a table.
+	// Pass 0 sets the entries itself: draws for illegal positions and stalemates,
+	// checkmates, and unknown for the rest.  Pass n finds the positions that are
+	// won (n odd) or lost (n even) in n plies; these are only listed, because
+	// the other threads are reading the table.
+	CMoveList generatedMoves;
+	const bool kbLookingForWins = nPass % 2 == 1;
+
+	for( unsigned long long nIndex = nBeginIndex; nIndex < nEndIndex; ++nIndex )
+	{
+
+		if( nPass > 0  &&  pcTable[nIndex] != cnTablebaseUnknown )
+		{
+			continue;
+		}
+
+		if( !SetUpTablebasePosition( nMaterialKey, nIndex ) )
+		{
+			pcTable[nIndex] = cnTablebaseDraw;
+			continue;
+		}
+
+		CPlayer & player = GetPlayerToMove();
+
+		player.GenerateMoves( generatedMoves, eGenMoveType_All );
+
+		if( nPass == 0 )
+		{
+			pcTable[nIndex] = generatedMoves.IsEmpty() ? ( player.IsInCheck() ? 1 : cnTablebaseDraw ) : cnTablebaseUnknown;
+			continue;
+		}
+
+		// A win needs a move to a position that is lost in fewer plies;
+		// a loss needs every move to lead to a position that is won in fewer plies.
+		bool bResolved = !kbLookingForWins;
+
+		for( int i = 0; i < generatedMoves.Size(); ++i )
+		{
+			MakeMove( generatedMoves[i] );
+
+			const unsigned char knEntry = GetTablebaseEntryAllowingEnPassant();
+
+			UnmakeMove();
+
+			const bool kbDecided = knEntry != cnTablebaseDraw  &&  knEntry <= nPass;
+			const bool kbOpponentLoses = kbDecided  &&  ( knEntry - 1 ) % 2 == 0;
+
+			if( kbLookingForWins  &&  kbOpponentLoses )
+			{
+				bResolved = true;
+				break;
+			}
+			else if( !kbLookingForWins  &&  ( !kbDecided  ||  kbOpponentLoses ) )
+			{
+				bResolved = false;
+				break;
+			}
+		}
+
+		if( bResolved )
+		{
+			pResolvedIndices->push_back( nIndex );
+		}
+	}
+}
+
+
+void CGame::GenerateTablebase( const string & strDirectory, int nMaterialKey ) throw( CException )
+{
+	// Generate the table and write it to strDirectory, unless it is already
+	// available; first generate the tables that captures and promotions lead to.
+	// The positions are searched in passes, each split among the threads;
+	// pass n finds the positions in which a player is mated in n plies.
+
+	if( m_pTablebases->GetTable( nMaterialKey ) != 0 )
+	{
+		return;
+	}
+
+	vector<int> dependencies;
+	int nMaxDependencyEntry = 0;
+
+	GetTablebaseDependencies( nMaterialKey, dependencies );
+
+	for( size_t i = 0; i < dependencies.size(); ++i )
+	{
+
+		if( GetTablebaseNumPieces( dependencies[i] ) == 2 )
+		{
+			// Bare kings are a draw.
+			continue;
+		}
+
+		GenerateTablebase( strDirectory, dependencies[i] );
+
+		const unsigned char * const kpcDependency = m_pTablebases->GetTable( dependencies[i] );
+		const unsigned long long knDependencySize = GetTablebaseSize( dependencies[i] );
+
+		for( unsigned long long j = 0; j < knDependencySize; ++j )
+		{
+			nMaxDependencyEntry = max( nMaxDependencyEntry, (int)kpcDependency[j] );
+		}
+	}
+
+	const string kstrName = CTablebases::GetName( nMaterialKey );
+	const unsigned long long knSize = GetTablebaseSize( nMaterialKey );
+	const int knNumThreads = max( 1, (int)thread::hardware_concurrency() );
+	const chrono::steady_clock::time_point kStartTime = chrono::steady_clock::now();
+	vector<unsigned char> table;
+	vector<CAutoPtr<CGame> > threadGames;
+	vector<vector<unsigned long long> > resolvedIndices( knNumThreads );
+
+	try
+	{
+		table.resize( knSize );
+	}
+	catch( ... )
+	{
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+
+	for( int i = 0; i < knNumThreads; ++i )
+	{
+		// The copies share the tablebases, including this one while it is generated.
+		CGame * pThreadGame = 0;
+
+		try
+		{
+			pThreadGame = new CGame( *this );
+		}
+		catch( ... )
+		{
+		}
+
+		if( pThreadGame == 0 )
+		{
+			ThrowException( eStatus_ResourceAcquisitionFailed );
+		}
+
+		threadGames.push_back( pThreadGame );
+	}
+
+	m_pTablebases->SetTable( nMaterialKey, &table[0] );
+
+	int nNumPassesWithoutProgress = 0;
+	int nPass = 0;
+
+	for( ; nPass + 1 < cnTablebaseUnknown; ++nPass )
+	{
+		vector<thread> threads;
+		unsigned long long nNumResolved = 0;
+
+		for( int i = 0; i < knNumThreads; ++i )
+		{
+			resolvedIndices[i].clear();
+			threads.push_back( thread( &CGame::RunTablebasePass, (CGame *)threadGames[i], nMaterialKey, &table[0], nPass,
+				knSize * i / knNumThreads, knSize * ( i + 1 ) / knNumThreads, &resolvedIndices[i] ) );
+		}
+
+		for( int i = 0; i < knNumThreads; ++i )
+		{
+			threads[i].join();
+
+			for( size_t j = 0; j < resolvedIndices[i].size(); ++j )
+			{
+				table[resolvedIndices[i][j]] = (unsigned char)( nPass + 1 );
+			}
+
+			nNumResolved += resolvedIndices[i].size();
+		}
+
+		// Once the entries of the other tables have all been seen, three passes
+		// without progress mean that there will be no more.  (A line through
+		// en passant captures can skip two passes; see GetTablebaseEntryAllowingEnPassant().)
+		nNumPassesWithoutProgress = nNumResolved == 0 ? nNumPassesWithoutProgress + 1 : 0;
+
+		if( nPass > nMaxDependencyEntry  &&  nNumPassesWithoutProgress >= 3 )
+		{
+			break;
+		}
+	}
+
+	// What is still unknown is a draw.
+	unsigned long long nNumWins = 0;
+	unsigned long long nNumLosses = 0;
+	int nMaxPliesToMate = 0;
+
+	for( unsigned long long i = 0; i < knSize; ++i )
+	{
+
+		if( table[i] == cnTablebaseUnknown )
+		{
+			table[i] = cnTablebaseDraw;
+		}
+		else if( table[i] != cnTablebaseDraw )
+		{
+
+			if( ( table[i] - 1 ) % 2 == 1 )
+			{
+				++nNumWins;
+			}
+			else
+			{
+				++nNumLosses;
+			}
+
+			nMaxPliesToMate = max( nMaxPliesToMate, table[i] - 1 );
+		}
+	}
+
+	m_pTablebases->SetTable( nMaterialKey, 0 );
+
+	const string kstrPath = CTablebases::GetPath( strDirectory, nMaterialKey );
+	ofstream file( kstrPath.c_str(), ios::out | ios::binary | ios::trunc );
+
+	file.write( (const char *)&table[0], knSize );
+	file.close();
+
+	if( !file  ||  !m_pTablebases->LoadTable( strDirectory, nMaterialKey ) )
+	{
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+
+	cout << kstrName << ": " << nNumWins << " wins and " << nNumLosses << " losses for the player to move; longest mate " <<
+		nMaxPliesToMate << " plies; " << nPass + 1 << " passes in " <<
+		chrono::duration<double>( chrono::steady_clock::now() - kStartTime ).count() << " seconds" << endl;
+}
+
+
+// Positions whose entries are known, to check the tables against.  Both turn on
+// an en passant capture, which the entries themselves don't cover: in the first,
+// 1. a4 would escape the pawn and win, but 1. ... bxa3 e.p. draws; in the second,
+// 1. d4 would escape the pawn and draw, but 1. ... cxd3 e.p. wins for Black.
+
+class CTablebaseReference
+{
+public:
+	const char * m_pcFEN;
+	unsigned char m_nExpectedEntry;
+};
+
+
+static const CTablebaseReference caTablebaseReferences[] =
+{
+	{ "8/8/8/8/1p6/6k1/P7/K7 w - - 0 1", cnTablebaseDraw },
+	{ "8/8/8/8/2p5/8/K2P4/2k5 w - - 0 1", 25 }		// White is mated in 24 plies.
+};
+
+
+bool CGame::CheckTablebases( void ) throw( CException )
+{
+	// Check the loaded tables against the reference positions that they cover.
+	const int knNumReferences = sizeof( caTablebaseReferences ) / sizeof( caTablebaseReferences[0] );
+	bool bAllPassed = true;
+
+	for( int i = 0; i < knNumReferences; ++i )
+	{
+		const CTablebaseReference & kReference = caTablebaseReferences[i];
+
+		LoadFEN( kReference.m_pcFEN );
+
+		const unsigned char knEntry = GetTablebaseEntry();
+
+		if( knEntry != cnTablebaseUnknown  &&  knEntry != kReference.m_nExpectedEntry )
+		{
+			cout << "Tablebase check FAILED: " << kReference.m_pcFEN << ": expected " <<
+				(int)kReference.m_nExpectedEntry << ", got " << (int)knEntry << endl;
+			bAllPassed = false;
+		}
+	}
+
+	return( bAllPassed );
+}
+
+
+bool CGame::GenerateTablebases( const string & strDirectory, int nMaxNumPieces ) throw( CException )
+{
+	// Generate every table with up to nMaxNumPieces pieces that isn't already in strDirectory,
+	// then check the tables.  Returns false if a table disagrees with a reference position.
+
+	if( nMaxNumPieces < 3  ||  nMaxNumPieces > cnMaxNumTablebasePieces )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	CGame game( 1 );
+
+	game.m_pTablebases->Load( strDirectory );
+
+	for( int nNumPieces = 3; nNumPieces <= nMaxNumPieces; ++nNumPieces )
+	{
+
+		for( int nMaterialKey = 0; nMaterialKey < 1 << ( 4 * ( eNumPieceTypes - 1 ) ); ++nMaterialKey )
+		{
+
+			if( GetTablebaseNumPieces( nMaterialKey ) == nNumPieces  &&  IsCanonicalTablebaseMaterialKey( nMaterialKey ) )
+			{
+				game.GenerateTablebase( strDirectory, nMaterialKey );
+			}
+		}
+	}
+
+	return( game.CheckTablebases() );
+}
+
+
+int CGame::LoadTablebases( const string & strDirectory )
+{
+	return( m_pTablebases->Load( strDirectory ) );
+}
+
+
+unsigned long long CGame::RunPerft( int nDepth, bool bDivide )
+{
+	// Count and report the leaf nodes of the legal move tree, optionally
+	// broken down by the first move, and the move generator's speed.
+	CPlayer & player = GetPlayerToMove();
+	const chrono::steady_clock::time_point kStartTime = chrono::steady_clock::now();
+	unsigned long long nNumLeafNodes = 0;
+
+	if( bDivide  &&  nDepth > 0 )
+	{
+		CMoveList generatedMoves;
+
+		player.GenerateMoves( generatedMoves, eGenMoveType_All );
+
+		const int knNumGeneratedMoves = generatedMoves.Size();
+
+		for( int i = 0; i < knNumGeneratedMoves; ++i )
+		{
+			const string kstrMove = MoveToString( generatedMoves[i] );
+
+			MakeMove( generatedMoves[i] );
+
+			const unsigned long long knNumMoveLeafNodes = player.m_Opponent.Perft( nDepth - 1 );
+
+			cout << kstrMove << ": " << knNumMoveLeafNodes << endl;
+			nNumLeafNodes += knNumMoveLeafNodes;
+			UnmakeMove();
+		}
+	}
+	else
+	{
+		nNumLeafNodes = player.Perft( nDepth );
+	}
+
+	const double kdSeconds = chrono::duration<double>( chrono::steady_clock::now() - kStartTime ).count();
+
+	cout << "Nodes: " << nNumLeafNodes << endl;
+	cout << "Time: " << kdSeconds << " s" << endl;
+	cout << "NPS: " << (unsigned long long)( kdSeconds > 0.0 ? nNumLeafNodes / kdSeconds : 0.0 ) << endl;
+
+	return( nNumLeafNodes );
+}
+
+
+// Standard perft reference positions, with the leaf node counts at depths 1, 2, 3, ...
+
+class CPerftReference
+{
+public:
+	const char * m_pcName;
+	const char * m_pcFEN;
+	unsigned long long m_anExpectedLeafNodes[6];
+};
+
+
+static const CPerftReference caPerftReferences[] =
+{
+	{ "Initial position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		{ 20ULL, 400ULL, 8902ULL, 197281ULL, 4865609ULL, 119060324ULL } },
+	{ "Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		{ 48ULL, 2039ULL, 97862ULL, 4085603ULL, 193690690ULL, 0ULL } },
+	{ "Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+		{ 14ULL, 191ULL, 2812ULL, 43238ULL, 674624ULL, 11030083ULL } },
+	{ "Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+		{ 6ULL, 264ULL, 9467ULL, 422333ULL, 15833292ULL, 0ULL } },
+	{ "Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+		{ 44ULL, 1486ULL, 62379ULL, 2103487ULL, 89941194ULL, 0ULL } },
+	{ "Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+		{ 46ULL, 2079ULL, 89890ULL, 3894594ULL, 164075551ULL, 0ULL } }
+};
+
+
+// The reference keys published with the Polyglot book format: the initial position,
+// then after 1. e4, 1. ... d5, 2. e5, 2. ... f5, 3. Ke2 and 3. ... Kf7; and after
+// 1. a4 b5 2. h4 b4 3. c4, then 3. ... bxc3 4. Ra3.
+
+class CPolyglotKeyReference
+{
+public:
+	const char * m_pcFEN;
+	HashKeyType m_nExpectedKey;
+};
+
+
+static const CPolyglotKeyReference caPolyglotKeyReferences[] =
+{
+	{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463B96181691FC9CULL },
+	{ "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823C9B50FD114196ULL },
+	{ "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756B94461C50FB0ULL },
+	{ "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662FAFB965DB29D4ULL },
+	{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22A48B5A8E47FF78ULL },
+	{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652A607CA3F242C1ULL },
+	{ "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00FDD303C946BDD9ULL },
+	{ "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3C8123EA7B067637ULL },
+	{ "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5C3F9B829B279560ULL }
+};
+
+
+void CGame::RunFENBenchmark( const char * pcPath ) throw( CException )
+{
+	// Load every position in a FEN or EPD file, and report the rate.
+	// The hash keys are combined into a checksum, so that runs can be compared.
+	CPositionFileReader reader( pcPath );
+	CGame game( 1 );
+	unsigned long long nNumPositions = 0;
+	unsigned long long nNumInvalidPositions = 0;
+	HashKeyType nChecksum = 0;
+	const char * pcLine = 0;
+	bool bIsTooLong = false;
+	const chrono::steady_clock::time_point kStartTime = chrono::steady_clock::now();
+
+	while( ( pcLine = reader.ReadLine( bIsTooLong ) ) != 0 )
+	{
+
+		if( bIsTooLong )
+		{
+			++nNumInvalidPositions;
+			continue;
+		}
+
+		try
+		{
+			game.LoadFEN( pcLine );
+			nChecksum = nChecksum * 0x9E3779B97F4A7C15ULL + game.m_nHashKey;
+			++nNumPositions;
+		}
+		catch( ... )
+		{
+			++nNumInvalidPositions;
+		}
+	}
+
+	const double kdSeconds = chrono::duration<double>( chrono::steady_clock::now() - kStartTime ).count();
+
+	cout << "Positions loaded: " << nNumPositions << "; invalid: " << nNumInvalidPositions << endl;
+	cout << "Time: " << kdSeconds << " seconds; positions per second: " <<
+		( kdSeconds > 0.0 ? (unsigned long long)( nNumPositions / kdSeconds ) : 0ULL ) << endl;
+	cout << "Checksum: " << nChecksum << endl;
+}
+
+
+bool CGame::RunPerftSuite( int nMaxDepth ) throw( CException )
+{
+	// Run each reference position to each depth up to nMaxDepth (as far as
+	// the expected counts are known), and check the counts.
+	const int knNumReferences = sizeof( caPerftReferences ) / sizeof( caPerftReferences[0] );
+	CGame game( 1 );
+	unsigned long long nTotalLeafNodes = 0;
+	double dTotalSeconds = 0.0;
+	bool bAllPassed = true;
+
+	for( int i = 0; i < knNumReferences; ++i )
+	{
+		const CPerftReference & kReference = caPerftReferences[i];
+
+		game.LoadFEN( kReference.m_pcFEN );
+		cout << kReference.m_pcName << ": " << kReference.m_pcFEN << endl;
+
+		for( int nDepth = 1; nDepth <= nMaxDepth  &&  nDepth <= 6; ++nDepth )
+		{
+			const unsigned long long knExpected = kReference.m_anExpectedLeafNodes[nDepth - 1];
+
+			if( knExpected == 0 )
+			{
+				break;
+			}
+
+			const chrono::steady_clock::time_point kStartTime = chrono::steady_clock::now();
+			const unsigned long long knActual = game.GetPlayerToMove().Perft( nDepth );
+			const double kdSeconds = chrono::duration<double>( chrono::steady_clock::now() - kStartTime ).count();
+			const bool kbPassed = knActual == knExpected;
+
+			cout << "  Depth " << nDepth << ": " << knActual << ( kbPassed ? " ok" : " FAILED; expected " );
+
+			if( !kbPassed )
+			{
+				cout << knExpected;
+				bAllPassed = false;
+			}
+
+			cout << " (" << kdSeconds << " s)" << endl;
+			nTotalLeafNodes += knActual;
+			dTotalSeconds += kdSeconds;
+		}
+	}
+
+	cout << ( bAllPassed ? "All perft counts are correct." : "Some perft counts are WRONG." ) << endl;
+	cout << "Nodes: " << nTotalLeafNodes << endl;
+	cout << "Time: " << dTotalSeconds << " s" << endl;
+	cout << "NPS: " << (unsigned long long)( dTotalSeconds > 0.0 ? nTotalLeafNodes / dTotalSeconds : 0.0 ) << endl;
+
+	return( bAllPassed );
+}
+
+
+bool CGame::CheckPolyglotKeys( void ) throw( CException )
+{
+	// Check the opening book keys against Polyglot's reference keys.
+	const int knNumReferences = sizeof( caPolyglotKeyReferences ) / sizeof( caPolyglotKeyReferences[0] );
+	CGame game( 1 );
+	bool bAllPassed = true;
+
+	for( int i = 0; i < knNumReferences; ++i )
+	{
+		const CPolyglotKeyReference & kReference = caPolyglotKeyReferences[i];
+
+		game.LoadFEN( kReference.m_pcFEN );
+
+		if( game.ComputePolyglotKey() != kReference.m_nExpectedKey )
+		{
+			cout << "Polyglot key FAILED: " << kReference.m_pcFEN << endl;
+			bAllPassed = false;
+		}
+	}
+
+	cout << ( bAllPassed ? "All Polyglot keys are correct." : "Some Polyglot keys are WRONG." ) << endl;
+	return( bAllPassed );
+}
+
+
+int CGame::GetSearchTimeInMilliseconds( void ) const
+{
+	return( (int)chrono::duration_cast<chrono::milliseconds>( chrono::steady_clock::now() - m_SearchStartTime ).count() );
+}
+
+
+void CGame::SetNumSearchThreads( int nNumSearchThreads ) throw( CException )
+{
+
+	if( nNumSearchThreads < 1 )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	m_nNumSearchThreads = nNumSearchThreads;
+}
+
+
+void CGame::SetRandomSeed( unsigned long long nSeed )
+{
+	// By default, the generator is seeded with the time at which the game was created.
+	m_RandomNumberGenerator.Seed( nSeed );
+}
+
+
+void CGame::PrepareSearch( const CSearchLimits & limits )
+{
+	m_SearchLimits = limits;
+	m_bEnforceSearchLimits = false;
+	m_bStopSearch = false;
+	m_nNumSearchNodes = 0;
+	m_nNumHelperSearchNodes = 0;
+	m_SearchStartTime = chrono::steady_clock::now();
+	m_SearchStatistics.Clear();
+	memset( m_aaanHistory, 0, sizeof( m_aaanHistory ) );
+
+	for( int i = 0; i < cnMaxSearchPly; ++i )
+	{
+
+		for( int j = 0; j < cnNumKillerMoves; ++j )
+		{
+			m_aaKillerMoves[i][j] = CMove();
+		}
+	}
+
+	for( int i = 0; i < 2; ++i )
+	{
+
+		for( int j = 0; j < eNumPieceTypes; ++j )
+		{
+
+			for( int k = 0; k < cnBoardArea; ++k )
+			{
+				m_aaaCounterMoves[i][j][k] = CMove();
+			}
+		}
+	}
+}
+
+
+void CGame::RecordQuietCutoff( int nPly, int nDepth, const CMove & move )
+{
+	// A quiet move of the player to move caused a cutoff; try it early in
+	// the sibling positions, and wherever else it is available.
+	CMove * const kaKillerMoves = m_aaKillerMoves[nPly];
+	int & nHistory = m_aaanHistory[m_nPlayerToMove][move.GetSrcSquare()][move.GetDstSquare()];
+
+	if( !( move == kaKillerMoves[0] ) )
+	{
+
+		for( int i = cnNumKillerMoves - 1; i > 0; --i )
+		{
+			kaKillerMoves[i] = kaKillerMoves[i - 1];
+		}
+
+		kaKillerMoves[0] = move;
+	}
+
+	// Cutoffs near the root save more work, so they count for more.
+	nHistory += nDepth * nDepth;
+
+	if( nHistory >= cnMaxHistoryValue )
+	{
+		int * const kpnHistory = &m_aaanHistory[m_nPlayerToMove][0][0];
+
+		for( int i = 0; i < cnBoardArea * cnBoardArea; ++i )
+		{
+			kpnHistory[i] /= 2;
+		}
+	}
+
+	if( m_nNumUndoRecords > 0 )
+	{
+		const CUndoRecord & kPreviousMove = m_aUndoRecords[m_nNumUndoRecords - 1];
+
+		m_aaaCounterMoves[m_nPlayerToMove][kPreviousMove.m_MovingPieceType][kPreviousMove.m_Move.GetDstSquare()] = move;
+	}
+}
+
+
+ScoreType CGame::Search( const CSearchLimits & limits, CMove & bestMove, bool bReportProgress )
+{
+	// Lazy SMP: helper threads search the same root, each on its own copy of
+	// the game, and share only the transposition table.  They don't report
+	// their results; what they store in the table guides the main thread,
+	// which searches until the limits are reached and then stops the helpers.
+	vector<CAutoPtr<CGame> > helperGames;
+	vector<thread> helperThreads;
+
+	PrepareSearch( limits );
+	m_pTranspositionTable->NewSearch();
+
+	for( int i = 1; i < m_nNumSearchThreads; ++i )
+	{
+		CGame * pHelperGame = 0;
+
+		try
+		{
+			pHelperGame = new CGame( *this );
+		}
+		catch( ... )
+		{
+		}
+
+		if( pHelperGame == 0 )
+		{
+			break;
+		}
+
+		helperGames.push_back( pHelperGame );
+		pHelperGame->m_RandomNumberGenerator.Seed( m_RandomNumberGenerator.GetNext() );
+		pHelperGame->PrepareSearch( CSearchLimits() );
+		pHelperGame->m_pMainThreadGame = this;
+
+		try
+		{
+			// Half of the helpers start one ply deeper, so that the threads
+			// are not all working on the same iteration.
+			helperThreads.push_back( thread( &CGame::RunHelperSearch, pHelperGame, 1 + i % 2 ) );
+		}
+		catch( ... )
+		{
+			// The thread couldn't be started; search with the threads we have.
+			helperGames.pop_back();
+			break;
+		}
+	}
+
+	ScoreType nBestLineValue = 0;
+	bool bExceptionThrown = false;
+
+	try
+	{
+		nBestLineValue = IterativeDeepening( 1, bestMove, bReportProgress );
+	}
+	catch( ... )
+	{
+		// The helpers must be stopped before their games are destroyed.
+		bExceptionThrown = true;
+	}
+
+	for( size_t i = 0; i < helperThreads.size(); ++i )
+	{
+		helperGames[i]->m_bStopSearch = true;
+	}
+
+	// Keep each thread's statistics, and then make the main thread's the totals.
+	m_SearchStatistics.m_nNumNodes = m_nNumSearchNodes;
+	m_ThreadSearchStatistics.assign( 1, m_SearchStatistics );
+
+	for( size_t i = 0; i < helperThreads.size(); ++i )
+	{
+		helperThreads[i].join();
+		helperGames[i]->m_SearchStatistics.m_nNumNodes = helperGames[i]->m_nNumSearchNodes;
+		m_ThreadSearchStatistics.push_back( helperGames[i]->m_SearchStatistics );
+		m_SearchStatistics.AddCounters( helperGames[i]->m_SearchStatistics );
+		m_nNumSearchNodes += helperGames[i]->m_nNumSearchNodes;
+	}
+
+	m_SearchStatistics.m_nNumNodes = m_nNumSearchNodes;
+	m_SearchStatistics.m_nMilliseconds = GetSearchTimeInMilliseconds();
+
+	if( bReportProgress )
+	{
+		lock_guard<mutex> lock( gs_OutputMutex );
+
+		cout << "info string statistics " << GetSearchStatisticsJSON() << endl;
+	}
+
+	if( bExceptionThrown )
+	{
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+
+	return( nBestLineValue );
+}
+
+
+string CGame::GetSearchStatisticsJSON( void ) const
+{
+	// The statistics of the last search, as one line of JSON: the totals over
+	// all of the threads, each thread's counters, and the main thread's iterations.
+	ostringstream ossJSON;
+
+	ossJSON << "{";
+	m_SearchStatistics.WriteCountersJSON( ossJSON );
+	ossJSON << ",\"time_ms\":" << m_SearchStatistics.m_nMilliseconds << ",\"threads\":[";
+
+	for( size_t i = 0; i < m_ThreadSearchStatistics.size(); ++i )
+	{
+		ossJSON << ( i > 0 ? ",{" : "{" );
+		m_ThreadSearchStatistics[i].WriteCountersJSON( ossJSON );
+		ossJSON << "}";
+	}
+
+	ossJSON << "],\"iterations\":";
+	m_SearchStatistics.WriteIterationsJSON( ossJSON );
+	ossJSON << "}";
+	return( ossJSON.str() );
+}
+
+
+void CGame::RunHelperSearch( int nFirstDepth )
+{
+	// The body of a helper thread.
+	CMove bestMove;
+
+	try
+	{
+		IterativeDeepening( nFirstDepth, bestMove, false );
+	}
+	catch( ... )
+	{
+		// The main thread's search is unaffected.
+	}
+}
+
+
+ScoreType CGame::IterativeDeepening( int nFirstDepth, CMove & bestMove, bool bReportProgress )
+{
+	// Search to depth nFirstDepth, nFirstDepth + 1, ... until a limit is reached.
+	// An interrupted iteration is abandoned; the best move and the value are
+	// those of the last completed iteration.  bestMove is left as CMove()
+	// if the player to move has no moves.
+	CPlayer & player = GetPlayerToMove();
+	ScoreType nBestLineValue = 0;
+
+	bestMove = CMove();
+
+	for( int nDepth = nFirstDepth; nDepth <= cnMaxSearchDepth; ++nDepth )
+	{
+
+		if( m_SearchLimits.m_nMaxDepth != 0  &&  nDepth > m_SearchLimits.m_nMaxDepth )
+		{
+			break;
+		}
+
+		CMove iterationBestMove;
+		const ScoreType knLineValue = player.FindBestMove( &iterationBestMove, 0, nDepth - 1, -cnInfiniteScore, cnInfiniteScore );
+
+		if( m_bStopSearch )
+		{
+			break;
+		}
+
+		m_bEnforceSearchLimits = true;
+
+		if( iterationBestMove == CMove() )
+		{
+			// There is nothing to search.
+			break;
+		}
+
+		bestMove = iterationBestMove;
+		nBestLineValue = knLineValue;
+
+		const int knMilliseconds = GetSearchTimeInMilliseconds();
+
+		m_SearchStatistics.AddIteration( nDepth, m_nNumSearchNodes, knMilliseconds );
+
+		if( bReportProgress )
+		{
+			// The nodes and the speed are those of all of the threads.
+			const unsigned long long knNumNodes = m_nNumSearchNodes + m_nNumHelperSearchNodes;
+			lock_guard<mutex> lock( gs_OutputMutex );
+
+			cout << "info depth " << nDepth << " score " << ScoreToString( knLineValue ) <<
+				" nodes " << knNumNodes << " time " << knMilliseconds <<
+				" nps " << ( knMilliseconds > 0 ? knNumNodes * 1000 / knMilliseconds : 0 ) <<
+				" pv " << MoveToString( bestMove ) << endl;
+		}
+
+		// The next iteration will take longer than all of the previous ones
+		// together, so don't start it if more than half of the time is gone.
+
+		if( m_SearchLimits.m_nMaxTimeInMilliseconds != 0  &&  2 * knMilliseconds >= m_SearchLimits.m_nMaxTimeInMilliseconds )
+		{
+			break;
+		}
+
+		// Once a mate has been found, deeper searches can't improve on it.
+
+		if( IsMateScore( knLineValue ) )
+		{
+			break;
+		}
+	}
+
+	m_bEnforceSearchLimits = false;
+	return( nBestLineValue );
+}
+
+
+void CGame::RunSMPBenchmark( int nNumThreads, int nDepth, const char * pcFEN, unsigned long long nRandomSeed ) throw( CException )
+{
+	// Search the position to the given depth on one thread and then on
+	// nNumThreads threads, each time with an empty transposition table
+	// and the same random seed, and report the speedup in the time taken
+	// to reach the depth.
+	double adSeconds[2] = { 0.0, 0.0 };
+	unsigned long long anNumNodes[2] = { 0, 0 };
+
+	for( int i = 0; i < 2; ++i )
+	{
+		const int knNumThreads = i == 0 ? 1 : nNumThreads;
+		CGame game;
+		CMove bestMove;
+
+		if( pcFEN != 0 )
+		{
+			game.LoadFEN( pcFEN );
+		}
+
+		game.SetNumSearchThreads( knNumThreads );
+		game.SetRandomSeed( nRandomSeed );
+
+		const chrono::steady_clock::time_point kStartTime = chrono::steady_clock::now();
+		const ScoreType knLineValue = game.Search( CSearchLimits( nDepth ), bestMove, false );
+
+		adSeconds[i] = chrono::duration<double>( chrono::steady_clock::now() - kStartTime ).count();
+		anNumNodes[i] = game.m_nNumSearchNodes;
+
+		cout << knNumThreads << " thread(s): best move " << game.MoveToString( bestMove ) <<
+			" score " << ScoreToString( knLineValue ) << "; " << anNumNodes[i] << " nodes in " << adSeconds[i] << " s (" <<
+			(unsigned long long)( adSeconds[i] > 0.0 ? anNumNodes[i] / adSeconds[i] : 0.0 ) << " NPS)" << endl;
+	}
+
+	if( adSeconds[1] > 0.0  &&  adSeconds[0] > 0.0 )
+	{
+		cout << "Time to depth speedup: " << adSeconds[0] / adSeconds[1] << endl;
+		cout << "NPS speedup: " << ( anNumNodes[1] / adSeconds[1] ) / ( anNumNodes[0] / adSeconds[0] ) << endl;
+	}
+}
+
+
+PieceTypeType CGame::MakeMove( const CMove & move )
+{
+	// Make the given move for the player to move, and record how to take it back.
+	// Returns the type of the captured piece, or ePieceType_Null.
+	const int knPlayerID = m_nPlayerToMove;
+	const int knOpponentID = 1 - knPlayerID;
+	const int knSrcSquare = move.GetSrcSquare();
+	const int knDstSquare = move.GetDstSquare();
+	const HashKeyType knOldCastlingAndEnPassantHashKey = GetCastlingAndEnPassantHashKey();
+	const PieceTypeType kMovingPieceType = GetPieceTypeOnSquare( knPlayerID, knSrcSquare );
+	PieceTypeType CapturedPieceType = ePieceType_Null;
+
+	Assert( m_nNumUndoRecords < cnMaxNumUndoRecords );
+	Assert( kMovingPieceType != ePieceType_Null );
+
+	CUndoRecord & undoRecord = m_aUndoRecords[m_nNumUndoRecords++];
+
+	undoRecord.m_nHashKey = m_nHashKey;
+	undoRecord.m_Move = move;
+	undoRecord.m_MovingPieceType = (unsigned char)kMovingPieceType;
+	undoRecord.m_nCastlingRights = (unsigned char)m_nCastlingRights;
+	undoRecord.m_nPawnCapturableViaEnPassant = (signed char)m_nPawnCapturableViaEnPassant;
+	undoRecord.m_nHalfMoveClock = (unsigned short)m_nHalfMoveClock;
+
+	m_nPawnCapturableViaEnPassant = -1;
+
+	if( move.IsCastling() )
+	{
+		// The king's move is the move; the rook jumps over the king.
+		const int knBackRowSquare = knSrcSquare - 4;
+
+		Assert( kMovingPieceType == ePieceType_King );
+
+		if( knDstSquare > knSrcSquare )
+		{
+			MovePiece( knPlayerID, ePieceType_Rook, knBackRowSquare + 7, knBackRowSquare + 5 );
+		}
+		else
+		{
+			MovePiece( knPlayerID, ePieceType_Rook, knBackRowSquare + 0, knBackRowSquare + 3 );
+		}
+	}
+	else if( move.IsEnPassant() )
+	{
+		// The captured pawn isn't on the destination square.
+		CapturedPieceType = ePieceType_Pawn;
+		RemovePiece( knOpponentID, ePieceType_Pawn, ( knSrcSquare / 8 ) * 8 + knDstSquare % 8 );
+	}
+	else if( ( m_abbPlayerOccupancy[knOpponentID] & SquareToBitboard( knDstSquare ) ) != 0 )
+	{
+		CapturedPieceType = GetPieceTypeOnSquare( knOpponentID, knDstSquare );
+		RemovePiece( knOpponentID, CapturedPieceType, knDstSquare );
+	}
+
+	undoRecord.m_CapturedPieceType = (unsigned char)CapturedPieceType;
+
+	MovePiece( knPlayerID, kMovingPieceType, knSrcSquare, knDstSquare );
+
+	if( move.IsPromotion() )
+	{
+		// The pawn is replaced by the piece to which it is promoted.
+		RemovePiece( knPlayerID, ePieceType_Pawn, knDstSquare );
+		AddPiece( knPlayerID, move.GetPromotedTo(), knDstSquare );
+	}
+	else if( kMovingPieceType == ePieceType_Pawn  &&  abs( knDstSquare - knSrcSquare ) == 16 )
+	{
+		m_nPawnCapturableViaEnPassant = knDstSquare;
+	}
+
+	m_nCastlingRights &= canCastlingRightsMasks[knSrcSquare] & canCastlingRightsMasks[knDstSquare];
+	m_nHalfMoveClock = ( kMovingPieceType == ePieceType_Pawn  ||  CapturedPieceType != ePieceType_Null ) ? 0 : m_nHalfMoveClock + 1;
+	m_nFullMoveNumber += knPlayerID;
+
+	// Bring the hash key up to date; the piece keys have already been updated.
+	m_nPlayerToMove = knOpponentID;
+	m_nHashKey ^= knOldCastlingAndEnPassantHashKey ^ GetCastlingAndEnPassantHashKey() ^ cZobristKeys.m_nBlackToMoveKey;
+
+#ifdef TAW_DEBUG
+	Assert( m_nHashKey == ComputeHashKey() );
+	Assert( m_anPieceSquareValues[0] == ComputePieceSquareValue( 0 ) );
+	Assert( m_anPieceSquareValues[1] == ComputePieceSquareValue( 1 ) );
+#endif
+
+	return( CapturedPieceType );
+}
+
+
+void CGame::UnmakeMove( void )
+{
+	// Take back the last move made by MakeMove().
+	Assert( m_nNumUndoRecords > 0 );
+
+	const CUndoRecord & kUndoRecord = m_aUndoRecords[--m_nNumUndoRecords];
+	const CMove & kMove = kUndoRecord.m_Move;
+	const int knOpponentID = m_nPlayerToMove;
+	const int knPlayerID = 1 - knOpponentID;
+	const int knSrcSquare = kMove.GetSrcSquare();
+	const int knDstSquare = kMove.GetDstSquare();
+	const PieceTypeType kCapturedPieceType = (PieceTypeType)kUndoRecord.m_CapturedPieceType;
+
+	if( kMove.IsPromotion() )
+	{
+		RemovePiece( knPlayerID, kMove.GetPromotedTo(), knDstSquare );
+		AddPiece( knPlayerID, ePieceType_Pawn, knDstSquare );
+	}
+
+	MovePiece( knPlayerID, (PieceTypeType)kUndoRecord.m_MovingPieceType, knDstSquare, knSrcSquare );
+
+	if( kMove.IsCastling() )
+	{
+		const int knBackRowSquare = knSrcSquare - 4;
+
+		if( knDstSquare > knSrcSquare )
+		{
+			MovePiece( knPlayerID, ePieceType_Rook, knBackRowSquare + 5, knBackRowSquare + 7 );
+		}
+		else
+		{
+			MovePiece( knPlayerID, ePieceType_Rook, knBackRowSquare + 3, knBackRowSquare + 0 );
+		}
+	}
+	else if( kCapturedPieceType != ePieceType_Null )
+	{
+		AddPiece( knOpponentID, kCapturedPieceType,
+			kMove.IsEnPassant() ? ( knSrcSquare / 8 ) * 8 + knDstSquare % 8 : knDstSquare );
+	}
+
+	m_nPlayerToMove = knPlayerID;
+	m_nCastlingRights = kUndoRecord.m_nCastlingRights;
+	m_nPawnCapturableViaEnPassant = kUndoRecord.m_nPawnCapturableViaEnPassant;
+	m_nHalfMoveClock = kUndoRecord.m_nHalfMoveClock;
+	m_nFullMoveNumber -= knPlayerID;
+	m_nHashKey = kUndoRecord.m_nHashKey;
+}
+
+
+int CGame::CountRepetitions( void ) const
+{
+	// Count the earlier occurrences of the position, with the same player to move.
+	// A capture or a pawn move can't be taken back, so the search stops there.
+	int nNumRepetitions = 0;
+
+	for( int i = m_nNumUndoRecords - 2; i >= 0  &&  i >= m_nNumUndoRecords - m_nHalfMoveClock; i -= 2 )
+	{
+
+		if( m_aUndoRecords[i].m_nHashKey == m_nHashKey )
+		{
+			++nNumRepetitions;
+		}
+	}
+
+	return( nNumRepetitions );
+}
+
+
+bool CGame::HasInsufficientMaterial( void ) const
+{
+	// True if neither player can mate: the kings are alone, or with one bishop or knight between them.
+	BitboardType bbMinorPieces = 0;
+
+	for( int nPlayerID = 0; nPlayerID < 2; ++nPlayerID )
+	{
+
+		if( ( m_abbPieces[nPlayerID][ePieceType_Queen] | m_abbPieces[nPlayerID][ePieceType_Rook] |
+			m_abbPieces[nPlayerID][ePieceType_Pawn] ) != 0 )
+		{
+			return( false );
+		}
+
+		bbMinorPieces |= m_abbPieces[nPlayerID][ePieceType_Bishop] | m_abbPieces[nPlayerID][ePieceType_Knight];
+	}
+
+	return( PopCount( bbMinorPieces ) <= 1 );
+}
+
+
+HashKeyType CGame::ComputePolyglotKey( void ) const
+{
+	// The position's key in a Polyglot opening book.  It is only needed when
+	// the book is probed, so it is computed from scratch, not kept up to date.
+	HashKeyType nKey = 0;
+
+	for( int nPlayerID = 0; nPlayerID < 2; ++nPlayerID )
+	{
+
+		for( int nPieceType = 0; nPieceType < eNumPieceTypes; ++nPieceType )
+		{
+			// Polyglot's kinds run from pawns to kings, the reverse of the piece types here,
+			// with Black's before White's.
+			const int knKind = 2 * ( ePieceType_Pawn - nPieceType ) + ( nPlayerID == 0 ? 1 : 0 );
+			BitboardType bbPieces = m_abbPieces[nPlayerID][nPieceType];
+
+			while( bbPieces != 0 )
+			{
+				nKey ^= canPolyglotRandom64[64 * knKind + PopLowestBit( bbPieces )];
+			}
+		}
+	}
+
+	// The castling rights are in the same order as Polyglot's.
+
+	for( int i = 0; i < 4; ++i )
+	{
+
+		if( ( m_nCastlingRights & ( 1 << i ) ) != 0 )
+		{
+			nKey ^= canPolyglotRandom64[cnPolyglotCastlingOffset + i];
+		}
+	}
+
+	// Polyglot only counts the en passant square if a pawn stands ready to capture.
+
+	if( CanCaptureEnPassant() )
+	{
+		nKey ^= canPolyglotRandom64[cnPolyglotEnPassantOffset + m_nPawnCapturableViaEnPassant % 8];
+	}
+
+	if( m_nPlayerToMove == 0 )
+	{
+		nKey ^= canPolyglotRandom64[cnPolyglotWhiteToMoveOffset];
+	}
+
+	return( nKey );
+}
+
+
+HashKeyType CGame::ComputeHashKey( void ) const
+{
+	// Compute the hash key from scratch; moves update it incrementally.
+	HashKeyType nKey = GetCastlingAndEnPassantHashKey();
+
+	for( int i = 0; i < 2; ++i )
+	{
+
+		for( int j = 0; j < eNumPieceTypes; ++j )
+		{
+			BitboardType bbPieces = m_abbPieces[i][j];
+
+			while( bbPieces != 0 )
+			{
+				nKey ^= cZobristKeys.m_anPieceKeys[i][j][PopLowestBit( bbPieces )];
+			}
+		}
+	}
+
+	if( m_nPlayerToMove == 1 )
+	{
+		nKey ^= cZobristKeys.m_nBlackToMoveKey;
+	}
+
+	return( nKey );
+}
+
+
+int CGame::ComputePieceSquareValue( int nPlayerID ) const
+{
+	// Compute the player's piece placement bonus from scratch; it is normally updated incrementally.
+	int nValue = 0;
+
+	for( int i = 0; i < eNumPieceTypes; ++i )
+	{
+		BitboardType bbPieces = m_abbPieces[nPlayerID][i];
+
+		while( bbPieces != 0 )
+		{
+			nValue += cPieceSquareValues.m_anValues[nPlayerID][i][PopLowestBit( bbPieces )];
+		}
+	}
+
+	return( nValue );
+}
+
+
+BitboardType CGame::GetAttackersOfSquare( int nSquare, BitboardType bbOccupancy ) const
+{
+	// The pieces of either player that attack the given square, given the occupied squares.
+	// Only pieces on occupied squares are included, so that removed pieces can be ignored.
+	const BitboardType kbbDiagonalSliders =
+		m_abbPieces[0][ePieceType_Bishop] | m_abbPieces[1][ePieceType_Bishop] |
+		m_abbPieces[0][ePieceType_Queen] | m_abbPieces[1][ePieceType_Queen];
+	const BitboardType kbbStraightSliders =
+		m_abbPieces[0][ePieceType_Rook] | m_abbPieces[1][ePieceType_Rook] |
+		m_abbPieces[0][ePieceType_Queen] | m_abbPieces[1][ePieceType_Queen];
+
+	// A pawn attacks the square if a pawn of the other player on the square would attack the pawn.
+	const BitboardType kbbAttackers =
+		( cLeaperAttackTables.m_abbPawnAttacks[1][nSquare] & m_abbPieces[0][ePieceType_Pawn] ) |
+		( cLeaperAttackTables.m_abbPawnAttacks[0][nSquare] & m_abbPieces[1][ePieceType_Pawn] ) |
+		( cLeaperAttackTables.m_abbKnightAttacks[nSquare] & ( m_abbPieces[0][ePieceType_Knight] | m_abbPieces[1][ePieceType_Knight] ) ) |
+		( cLeaperAttackTables.m_abbKingAttacks[nSquare] & ( m_abbPieces[0][ePieceType_King] | m_abbPieces[1][ePieceType_King] ) ) |
+		( GetSliderAttacks( ePieceType_Bishop, nSquare, bbOccupancy ) & kbbDiagonalSliders ) |
+		( GetSliderAttacks( ePieceType_Rook, nSquare, bbOccupancy ) & kbbStraightSliders );
+
+	return( kbbAttackers & bbOccupancy );
+}
+
+
+PieceTypeType CGame::GetPieceTypeOnSquare( int nPlayerID, int nSquare ) const
+{
+	const BitboardType kbbSquare = SquareToBitboard( nSquare );
+
+	if( ( m_abbPlayerOccupancy[nPlayerID] & kbbSquare ) == 0 )
+	{
+		// The player has no piece on this square.
+		return( ePieceType_Null );
+	}
+
+	for( int i = 0; i < eNumPieceTypes; ++i )
+	{
+
+		if( ( m_abbPieces[nPlayerID][i] & kbbSquare ) != 0 )
+		{
+			return( (PieceTypeType)i );
+		}
+	}
+
+	return( ePieceType_Null );
+}
+
+
+void CGame::PrintBoard( void ) const
+{
+	// Display row 7 first, row 0 last.
+
+	for( int nRow = 7; nRow >= 0; --nRow )
+	{
+
+		for( int nCol = 0; nCol < 8; ++nCol )
+		{
+			char cOutput = '?';
+			const int knSquare = nRow * 8 + nCol;
+			const PieceTypeType kWhitePieceType = GetPieceTypeOnSquare( 0, knSquare );
+			const PieceTypeType kBlackPieceType = GetPieceTypeOnSquare( 1, knSquare );
+
+			if( kWhitePieceType != ePieceType_Null )
+			{
+				cOutput = caPieceArchetypes[kWhitePieceType].m_Printable;
+			}
+			else if( kBlackPieceType != ePieceType_Null )
+			{
+				// It's a black piece.
+				cOutput = caPieceArchetypes[kBlackPieceType].m_Printable + ( 'a' - 'A' );
+			}
+			else
+			{
+				cOutput = ( nRow + nCol ) % 2 == 0 ? '*' : ' ';
+			}
+
+			cout << cOutput;
+		}
+
+		cout << '\n';
+	}
+}
+
+
+// **** Class CUCIDriver ****
+
+// Lets a chess GUI drive the game through the Universal Chess Interface on
+// cin and cout.  The search runs on a thread of its own, so that commands
+// such as "stop" and "isready" are answered while it is in progress.
+
+class CUCIDriver
+{
+private:
+	CGame & m_Game;
+	COpeningBook m_OpeningBook;
+	thread m_SearchThread;
+	atomic<bool> m_bSearchIsRunning;
+	bool m_bWaitForStop;				// After "go infinite", report the best move only when told to stop.
+
+	void SetPosition( istringstream & issCommand ) throw( CException );
+	void SetOption( istringstream & issCommand ) throw( CException );
+	void StartSearch( istringstream & issCommand ) throw( CException );
+	void StopSearch( void );
+	void RunSearch( CSearchLimits limits );
+
+public:
+	explicit CUCIDriver( CGame & game );
+	~CUCIDriver( void );
+
+	void Run( void );
+
+}; // class CUCIDriver
+
+
+CUCIDriver::CUCIDriver( CGame & game )
+	: m_Game( game ),
+		m_bSearchIsRunning( false ),
+		m_bWaitForStop( false )
+{
+}
+
+
+CUCIDriver::~CUCIDriver( void )
+{
+	StopSearch();
+}
+
+
+void CUCIDriver::Run( void )
+{
+	string strLine;
+
+	while( getline( cin, strLine ) )
+	{
+		istringstream issCommand( strLine );
+		string strCommand;
+
+		issCommand >> strCommand;
+
+		try
+		{
+
+			if( strCommand == "uci" )
+			{
+				lock_guard<mutex> lock( gs_OutputMutex );
+
+				cout << "id name pdchess2" << endl;
+				cout << "id author Tom Weatherhead" << endl;
+				cout << "option name Hash type spin default " << cnDefaultTranspositionTableSizeInMB << " min 1 max 65536" << endl;
+				cout << "option name Threads type spin default 1 min 1 max 256" << endl;
+				cout << "option name Seed type string default <time>" << endl;
+				cout << "option name BookFile type string default <empty>" << endl;
+				cout << "option name TablebasePath type string default <empty>" << endl;
+				cout << "uciok" << endl;
+			}
+			else if( strCommand == "isready" )
+			{
+				// This is answered at once, even during a search.
+				lock_guard<mutex> lock( gs_OutputMutex );
+
+				cout << "readyok" << endl;
+			}
+			else if( strCommand == "ucinewgame" )
+			{
+				StopSearch();
+				m_Game.InitializeBoard();
+				m_Game.m_pTranspositionTable->Clear();
+			}
+			else if( strCommand == "position" )
+			{
+				StopSearch();
+				SetPosition( issCommand );
+			}
+			else if( strCommand == "setoption" )
+			{
+				StopSearch();
+				SetOption( issCommand );
+			}
+			else if( strCommand == "go" )
+			{
+				StopSearch();
+				StartSearch( issCommand );
+			}
+			else if( strCommand == "stop" )
+			{
+				StopSearch();
+			}
+			else if( strCommand == "quit" )
+			{
+				break;
+			}
+
+			// Other commands, eg. "debug" and "ponderhit", are ignored.
+		}
+		catch( const CException & e )
+		{
+			lock_guard<mutex> lock( gs_OutputMutex );
+
+			cout << "info string exception thrown on line " << e.GetLineNumber() << " for command: " << strLine << endl;
+		}
+	}
+
+	StopSearch();
+}
+
+
+void CUCIDriver::SetPosition( istringstream & issCommand ) throw( CException )
+{
+	// position startpos | fen <FEN> [moves <move> ...]
+	string strToken;
+
+	issCommand >> strToken;
+
+	if( strToken == "startpos" )
+	{
+		m_Game.InitializeBoard();
+		issCommand >> strToken;
+	}
+	else if( strToken == "fen" )
+	{
+		string strFEN;
+
+		while( issCommand >> strToken  &&  strToken != "moves" )
+		{
+			strFEN = strFEN + ( strFEN.empty() ? "" : " " ) + strToken;
+		}
+
+		m_Game.LoadFEN( strFEN.c_str() );
+	}
+	else
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	if( strToken != "moves" )
+	{
+		return;
+	}
+
+	while( issCommand >> strToken )
+	{
+		const CMove kMove = m_Game.StringToMove( strToken );
+
+		if( kMove == CMove() )
+		{
+			ThrowException( eStatus_InvalidParameter );
+		}
+
+		// Nothing unmakes the moves before the root, and the repetition check looks back
+		// no further than the last capture or pawn move, so when a long game fills the
+		// undo stack, only the records since then need to be kept.
+
+		if( m_Game.m_nNumUndoRecords >= cnMaxNumUndoRecords - cnMaxSearchPly - 1 )
+		{
+			const int knNumRecordsToKeep = min( m_Game.m_nHalfMoveClock, cnMaxNumUndoRecords / 2 );
+			const int knNumRecordsToDrop = m_Game.m_nNumUndoRecords - knNumRecordsToKeep;
+
+			for( int i = 0; i < knNumRecordsToKeep; ++i )
+			{
+				m_Game.m_aUndoRecords[i] = m_Game.m_aUndoRecords[knNumRecordsToDrop + i];
+			}
+
+			m_Game.m_nNumUndoRecords = knNumRecordsToKeep;
+		}
+
+		m_Game.MakeMove( kMove );
+	}
+}
+
+
+void CUCIDriver::SetOption( istringstream & issCommand ) throw( CException )
+{
+	// setoption name <name> value <value>
+	string strToken;
+	string strName;
+	string strValue;
+
+	issCommand >> strToken >> strName >> strToken >> strValue;
+
+	if( strName == "Hash" )
+	{
+		m_Game.m_pTranspositionTable->Resize( atoi( strValue.c_str() ) );
+	}
+	else if( strName == "Threads" )
+	{
+		m_Game.SetNumSearchThreads( atoi( strValue.c_str() ) );
+	}
+	else if( strName == "Seed" )
+	{
+		m_Game.SetRandomSeed( strtoull( strValue.c_str(), 0, 10 ) );
+	}
+	else if( strName == "TablebasePath" )
+	{
+		const int knNumTables = m_Game.LoadTablebases( strValue );
+		lock_guard<mutex> lock( gs_OutputMutex );
+
+		cout << "info string " << knNumTables << " tablebases loaded" << endl;
+	}
+	else if( strName == "BookFile" )
+	{
+
+		if( strValue.empty()  ||  strValue == "<empty>" )
+		{
+			m_OpeningBook.Close();
+		}
+		else
+		{
+			m_OpeningBook.Open( strValue.c_str() );
+		}
+	}
+}
+
+
+void CUCIDriver::StartSearch( istringstream & issCommand ) throw( CException )
+{
+	// go [depth <plies>] [nodes <n>] [movetime <ms>] [wtime <ms>] [btime <ms>]
+	//	[winc <ms>] [binc <ms>] [movestogo <n>] [infinite]
+	CSearchLimits limits;
+	int anTimeLeft[2] = { 0, 0 };
+	int anIncrement[2] = { 0, 0 };
+	int nMovesToGo = 0;
+	string strToken;
+
+	m_bWaitForStop = false;
+
+	while( issCommand >> strToken )
+	{
+
+		if( strToken == "depth" )
+		{
+			issCommand >> limits.m_nMaxDepth;
+		}
+		else if( strToken == "nodes" )
+		{
+			issCommand >> limits.m_nMaxNodes;
+		}
+		else if( strToken == "movetime" )
+		{
+			issCommand >> limits.m_nMaxTimeInMilliseconds;
+		}
+		else if( strToken == "wtime" )
+		{
+			issCommand >> anTimeLeft[0];
+		}
+		else if( strToken == "btime" )
+		{
+			issCommand >> anTimeLeft[1];
+		}
+		else if( strToken == "winc" )
+		{
+			issCommand >> anIncrement[0];
+		}
+		else if( strToken == "binc" )
+		{
+			issCommand >> anIncrement[1];
+		}
+		else if( strToken == "movestogo" )
+		{
+			issCommand >> nMovesToGo;
+		}
+		else if( strToken == "infinite" )
+		{
+			m_bWaitForStop = true;
+		}
+	}
+
+	const int knTimeLeft = anTimeLeft[m_Game.m_nPlayerToMove];
+
+	if( limits.m_nMaxTimeInMilliseconds == 0  &&  knTimeLeft > 0 )
+	{
+		limits.m_nMaxTimeInMilliseconds = GetMoveTimeInMilliseconds( knTimeLeft, anIncrement[m_Game.m_nPlayerToMove], nMovesToGo );
+	}
+
+	// A book move is played at once, without a search; but under "go infinite"
+	// the GUI wants an analysis of the position.
+
+	if( m_OpeningBook.IsOpen()  &&  !m_bWaitForStop )
+	{
+		const CMove kBookMove = m_Game.ProbeOpeningBook( m_OpeningBook );
+
+		if( !( kBookMove == CMove() ) )
+		{
+			lock_guard<mutex> lock( gs_OutputMutex );
+
+			cout << "info string book move" << endl;
+			cout << "bestmove " << m_Game.MoveToString( kBookMove ) << endl;
+			return;
+		}
+	}
+
+	m_Game.m_bStopRequested = false;
+	m_bSearchIsRunning = true;
+
+	try
+	{
+		m_SearchThread = thread( &CUCIDriver::RunSearch, this, limits );
+	}
+	catch( ... )
+	{
+		m_bSearchIsRunning = false;
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+}
+
+
+void CUCIDriver::StopSearch( void )
+{
+
+	if( !m_SearchThread.joinable() )
+	{
+		return;
+	}
+
+	// The search may not have begun yet, and the first iteration isn't
+	// interrupted, so keep asking until the search thread is done.
+
+	while( m_bSearchIsRunning )
+	{
+		m_Game.m_bStopRequested = true;
+		this_thread::sleep_for( chrono::milliseconds( 1 ) );
+	}
+
+	m_SearchThread.join();
+}
+
+
+void CUCIDriver::RunSearch( CSearchLimits limits )
+{
+	// The body of the search thread.
+	CMove bestMove;
+
+	try
+	{
+		m_Game.Search( limits, bestMove, true );
+	}
+	catch( ... )
+	{
+		// Report whatever move was found.
+	}
+
+	while( m_bWaitForStop  &&  !m_Game.m_bStopRequested )
+	{
+		this_thread::sleep_for( chrono::milliseconds( 1 ) );
+	}
+
+	{
+		lock_guard<mutex> lock( gs_OutputMutex );
+
+		cout << "bestmove " << ( bestMove == CMove() ? string( "0000" ) : m_Game.MoveToString( bestMove ) ) << endl;
+	}
+
+	m_bSearchIsRunning = false;
+}
+
+
+// **** Class CTestSuiteRunner ****
+
+// Runs a suite of test positions from an EPD file, in which each line holds the
+// first four fields of a FEN string followed by operations, eg.
+//	r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - bm Bb5; id "test 1";
+// The positions are shared out among several threads, each with its own game,
+// as the file is read.  A position is solved if the search's move is one of the
+// best moves ("bm") and none of the moves to avoid ("am").
+
+class CTestSuiteRunner
+{
+private:
+	CPositionFileReader m_Reader;
+	mutex m_Mutex;						// Guards the reader and the totals.
+	CSearchLimits m_SearchLimits;
+	unsigned long long m_nRandomSeed;
+	string m_strTablebaseDirectory;		// Empty for no tablebases.
+	int m_nNumPositions;
+	int m_nNumInvalidPositions;			// Including the lines that are too long.
+	int m_nNumScoredPositions;			// Those with "bm" or "am" operations.
+	int m_nNumSolvedPositions;
+	unsigned long long m_nNumSearchNodes;
+	vector<double> m_SearchMilliseconds;
+	bool m_bExceptionThrown;
+
+	bool ReadPosition( string & strLine, int & nPositionNumber, bool & bIsTooLong );
+	void RunPosition( CGame & game, const string & strLine, int nPositionNumber ) throw( CException );
+	void RunWorker( void );
+
+public:
+	CTestSuiteRunner( const char * pcPath, const CSearchLimits & limits, unsigned long long nRandomSeed,
+		const string & strTablebaseDirectory ) throw( CException );
+
+	bool Run( int nNumThreads ) throw( CException );
+
+}; // class CTestSuiteRunner
+
+
+CTestSuiteRunner::CTestSuiteRunner( const char * pcPath, const CSearchLimits & limits, unsigned long long nRandomSeed,
+		const string & strTablebaseDirectory ) throw( CException )
+	: m_Reader( pcPath ),
+		m_SearchLimits( limits ),
+		m_nRandomSeed( nRandomSeed ),
+		m_strTablebaseDirectory( strTablebaseDirectory ),
+		m_nNumPositions( 0 ),
+		m_nNumInvalidPositions( 0 ),
+		m_nNumScoredPositions( 0 ),
+		m_nNumSolvedPositions( 0 ),
+		m_nNumSearchNodes( 0 ),
+		m_bExceptionThrown( false )
+{
+}
+
+
+bool CTestSuiteRunner::ReadPosition( string & strLine, int & nPositionNumber, bool & bIsTooLong )
+{
+	// Read the next line that holds a position; returns false at the end of the file.
+	lock_guard<mutex> lock( m_Mutex );
+	const char * const kpcLine = m_Reader.ReadLine( bIsTooLong );
+
+	if( kpcLine == 0 )
+	{
+		return( false );
+	}
+
+	strLine = kpcLine;
+	nPositionNumber = ++m_nNumPositions;
+	return( true );
+}
+
+
+void CTestSuiteRunner::RunPosition( CGame & game, const string & strLine, int nPositionNumber ) throw( CException )
+{
+	istringstream issLine( strLine );
+	string strFEN;
+	string strField;
+
+	for( int i = 0; i < 4  &&  issLine >> strField; ++i )
+	{
+		strFEN = strFEN + ( i > 0 ? " " : "" ) + strField;
+	}
+
+	game.LoadFEN( strFEN.c_str() );
+
+	// Parse the operations: an opcode, then operands, then a semicolon.
+	vector<string> bestMoves;
+	vector<string> movesToAvoid;
+	string strID = to_string( nPositionNumber );
+	string strOperations;
+
+	getline( issLine, strOperations );
+
+	istringstream issOperations( strOperations );
+	string strOperation;
+
+	while( getline( issOperations, strOperation, ';' ) )
+	{
+		istringstream issOperation( strOperation );
+		string strOpcode;
+		string strOperand;
+
+		issOperation >> strOpcode;
+
+		if( strOpcode == "id" )
+		{
+			const size_t knFirstQuote = strOperation.find( '"' );
+			const size_t knLastQuote = strOperation.rfind( '"' );
+
+			if( knFirstQuote != string::npos  &&  knLastQuote > knFirstQuote )
+			{
+				strID = strOperation.substr( knFirstQuote + 1, knLastQuote - knFirstQuote - 1 );
+			}
+
+			continue;
+		}
+
+		while( issOperation >> strOperand )
+		{
+			// Check, checkmate and annotation suffixes are ignored.
+			strOperand = strOperand.substr( 0, strOperand.find_last_not_of( "+#!?" ) + 1 );
+
+			if( strOpcode == "bm" )
+			{
+				bestMoves.push_back( strOperand );
+			}
+			else if( strOpcode == "am" )
+			{
+				movesToAvoid.push_back( strOperand );
+			}
+		}
+	}
+
+	// Search from an empty transposition table and a fixed seed, so that the
+	// result doesn't depend on which thread runs the position, or when.
+	CMove bestMove;
+
+	game.m_pTranspositionTable->Clear();
+	game.SetRandomSeed( m_nRandomSeed );
+
+	const chrono::steady_clock::time_point kStartTime = chrono::steady_clock::now();
+
+	game.Search( m_SearchLimits, bestMove, false );
+
+	const double kdMilliseconds = chrono::duration<double, milli>( chrono::steady_clock::now() - kStartTime ).count();
+
+	// The moves may be written in SAN or in coordinate notation.
+	const string kstrSAN = bestMove == CMove() ? string( "(none)" ) : game.MoveToSAN( bestMove );
+	const string kstrCoordinates = bestMove == CMove() ? string( "(none)" ) : game.MoveToString( bestMove );
+	const bool kbIsScored = !bestMoves.empty()  ||  !movesToAvoid.empty();
+	bool bIsSolved = kbIsScored;
+
+	if( !bestMoves.empty() )
+	{
+		bIsSolved = find( bestMoves.begin(), bestMoves.end(), kstrSAN ) != bestMoves.end()  ||
+			find( bestMoves.begin(), bestMoves.end(), kstrCoordinates ) != bestMoves.end();
+	}
+
+	if( find( movesToAvoid.begin(), movesToAvoid.end(), kstrSAN ) != movesToAvoid.end()  ||
+		find( movesToAvoid.begin(), movesToAvoid.end(), kstrCoordinates ) != movesToAvoid.end() )
+	{
+		bIsSolved = false;
+	}
+
+	{
+		lock_guard<mutex> lock( m_Mutex );
+
+		m_nNumScoredPositions += kbIsScored ? 1 : 0;
+		m_nNumSolvedPositions += bIsSolved ? 1 : 0;
+		m_nNumSearchNodes += game.m_nNumSearchNodes;
+		m_SearchMilliseconds.push_back( kdMilliseconds );
+	}
+
+	lock_guard<mutex> lock( gs_OutputMutex );
+
+	cout << nPositionNumber << " " << strID << ": " << kstrSAN << " " <<
+		( !kbIsScored ? "-" : bIsSolved ? "solved" : "failed" ) << " " <<
+		game.m_nNumSearchNodes << " nodes " << (int)kdMilliseconds << " ms" << endl;
+}
+
+
+void CTestSuiteRunner::RunWorker( void )
+{
+	// The body of a worker thread.
+	CAutoPtr<CGame> pGame;
+	string strLine;
+	int nPositionNumber = 0;
+	bool bIsTooLong = false;
+
+	try
+	{
+		pGame = new CGame;
+	}
+	catch( ... )
+	{
+	}
+
+	if( pGame == 0 )
+	{
+		lock_guard<mutex> lock( m_Mutex );
+
+		m_bExceptionThrown = true;
+		return;
+	}
+
+	if( !m_strTablebaseDirectory.empty() )
+	{
+		pGame->LoadTablebases( m_strTablebaseDirectory );
+	}
+
+	while( ReadPosition( strLine, nPositionNumber, bIsTooLong ) )
+	{
+		// An invalid position is reported and skipped; the rest of the suite still runs.
+
+		try
+		{
+
+			if( bIsTooLong )
+			{
+				ThrowException( eStatus_InvalidParameter );
+			}
+
+			RunPosition( *pGame, strLine, nPositionNumber );
+		}
+		catch( ... )
+		{
+
+			{
+				lock_guard<mutex> lock( m_Mutex );
+
+				++m_nNumInvalidPositions;
 			}
+
+			lock_guard<mutex> lock( gs_OutputMutex );
+
+			cout << nPositionNumber << ": " << ( bIsTooLong ? "line too long: " : "invalid position: " ) <<
+				( bIsTooLong ? strLine.substr( 0, 60 ) + "..." : strLine ) << endl;
+		}
+	}
+}
+
+
+bool CTestSuiteRunner::Run( int nNumThreads ) throw( CException )
+{
+	// Run the suite and report the results; returns true if every scored position was solved.
+	vector<thread> threads;
+	const chrono::steady_clock::time_point kStartTime = chrono::steady_clock::now();
+
+	if( nNumThreads < 1 )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+
+	for( int i = 0; i < nNumThreads; ++i )
+	{
+
+		try
+		{
+			threads.push_back( thread( &CTestSuiteRunner::RunWorker, this ) );
+		}
+		catch( ... )
+		{
+			// Run with the threads we have.
+			break;
+		}
+	}
+
+	if( threads.empty() )
+	{
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+
+	for( size_t i = 0; i < threads.size(); ++i )
+	{
+		threads[i].join();
+	}
+
+	if( m_bExceptionThrown )
+	{
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+
+	const double kdSeconds = chrono::duration<double>( chrono::steady_clock::now() - kStartTime ).count();
+	const size_t knNumSearches = m_SearchMilliseconds.size();
+
+	cout << "Solved " << m_nNumSolvedPositions << " of " << m_nNumScoredPositions << " scored positions";
+
+	if( m_nNumScoredPositions > 0 )
+	{
+		cout << " (" << 100.0 * m_nNumSolvedPositions / m_nNumScoredPositions << "%)";
+	}
+
+	cout << "; " << knNumSearches << " positions searched on " << threads.size() << " threads in " << kdSeconds << " seconds";
+
+	if( m_nNumInvalidPositions > 0 )
+	{
+		cout << "; " << m_nNumInvalidPositions << " invalid positions skipped";
+	}
+
+	cout << endl;
+	cout << "Nodes: " << m_nNumSearchNodes << "; NPS: " << ( kdSeconds > 0.0 ? (unsigned long long)( m_nNumSearchNodes / kdSeconds ) : 0ULL ) << endl;
+
+	if( knNumSearches > 0 )
+	{
+		// The latency percentiles of the searches, by the nearest rank.
+		const int kanPercentiles[] = { 50, 90, 99, 100 };
+
+		sort( m_SearchMilliseconds.begin(), m_SearchMilliseconds.end() );
+		cout << "Search time (ms):";
+
+		for( size_t i = 0; i < sizeof( kanPercentiles ) / sizeof( kanPercentiles[0] ); ++i )
+		{
+			const size_t knRank = max( (size_t)1, ( knNumSearches * kanPercentiles[i] + 99 ) / 100 );
+
+			cout << " p" << kanPercentiles[i] << " " << m_SearchMilliseconds[knRank - 1];
 		}
+
+		cout << endl;
 	}
 
-	if( !bGenerateAttackingMovesOnly )
+	return( m_nNumSolvedPositions == m_nNumScoredPositions );
+}
+
+
+// **** Class CEngineConfiguration ****
+
+// The settings of one side of a match, parsed from a comma-separated list of
+// name=value pairs, eg. "hash=64,threads=2,timeodds=0.5,tablebases=tb".
+// "default" selects the defaults.
+
+class CEngineConfiguration
+{
+public:
+	string m_strName;
+	int m_nTranspositionTableSizeInMB;
+	int m_nNumSearchThreads;
+	double m_dTimeOdds;					// The clock's base time and increment are multiplied by this.
+	string m_strTablebaseDirectory;		// Empty for no tablebases.
+
+	explicit CEngineConfiguration( const string & strName = "" )
+		: m_strName( strName ),
+			m_nTranspositionTableSizeInMB( cnDefaultTranspositionTableSizeInMB ),
+			m_nNumSearchThreads( 1 ),
+			m_dTimeOdds( 1.0 )
 	{
-		// Try to generate the castling moves:
-		// 1) The king and the rook must not have been moved yet;
-		// 2) The squares between the king and the rook must be empty;
-		// 3) The squares that the king moves through and to must not be under attack;
-		// 4) The king must not be in check (you can't castle to escape check).
+	}
 
-		vector<CMove> opponentsAttackingMoves;
-		bool bOpponentsAttackingMovesGenerated = false;
+	void Parse( const string & strOptions ) throw( CException );
+	CAutoPtr<CGame> CreateGame( void ) const throw( CException );
+}; // class CEngineConfiguration
 
-		if( m_bCanCastleKingside  &&	// King and kingside rook not moved yet.
-				m_Game.m_aBoard[knBackRow * 8 + 5] == 0  &&	// f1 is vacant.
-				m_Game.m_aBoard[knBackRow * 8 + 6] == 0 )		// g1 is vacant.
-		{
-			// Generate attacking moves only.
-			m_Opponent.GenerateMoves( opponentsAttackingMoves, true );
-			bOpponentsAttackingMovesGenerated = true;
 
-			if(	!m_Opponent.IsAttackingSquare( opponentsAttackingMoves, knBackRow, 4 )  &&	// e1 is not under attack (ie. the king is not in check).
-					!m_Opponent.IsAttackingSquare( opponentsAttackingMoves, knBackRow, 5 )  &&	// f1 is not under attack.
-					!m_Opponent.IsAttackingSquare( opponentsAttackingMoves, knBackRow, 6 ) )		// g1 is not under attack.
-			{
-				// Board index 64 means castle kingside.
-				GeneratedMovesAList[6].push_back( CMove( 64, 64, ePieceType_Null ) );
-			}
-		}
+void CEngineConfiguration::Parse( const string & strOptions ) throw( CException )
+{
+	istringstream issOptions( strOptions );
+	string strOption;
+
+	while( getline( issOptions, strOption, ',' ) )
+	{
+		const size_t knEquals = strOption.find( '=' );
+		const string kstrName = strOption.substr( 0, knEquals );
+		const string kstrValue = knEquals != string::npos ? strOption.substr( knEquals + 1 ) : "";
 
-		if( m_bCanCastleQueenside  &&	// King and queenside rook not moved yet.
-				m_Game.m_aBoard[knBackRow * 8 + 1] == 0  &&	// b1 is vacant.
-				m_Game.m_aBoard[knBackRow * 8 + 2] == 0  &&	// c1 is vacant.
-				m_Game.m_aBoard[knBackRow * 8 + 3] == 0 )		// d1 is vacant.
+		if( kstrName == "default"  &&  knEquals == string::npos )
 		{
+			continue;
+		}
+		else if( kstrName == "hash" )
+		{
+			m_nTranspositionTableSizeInMB = atoi( kstrValue.c_str() );
+		}
+		else if( kstrName == "threads" )
+		{
+			m_nNumSearchThreads = atoi( kstrValue.c_str() );
+		}
+		else if( kstrName == "timeodds" )
+		{
+			m_dTimeOdds = atof( kstrValue.c_str() );
+		}
+		else if( kstrName == "tablebases" )
+		{
+			m_strTablebaseDirectory = kstrValue;
+		}
+		else
+		{
+			ThrowException( eStatus_InvalidParameter );
+		}
+	}
 
-			if( !bOpponentsAttackingMovesGenerated )
-			{
-				// Generate attacking moves only.
-				m_Opponent.GenerateMoves( opponentsAttackingMoves, true );
-				bOpponentsAttackingMovesGenerated = true;
-			}
+	if( m_nTranspositionTableSizeInMB < 1  ||  m_nNumSearchThreads < 1  ||  m_dTimeOdds <= 0.0 )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
+}
 
-			if( !m_Opponent.IsAttackingSquare( opponentsAttackingMoves, knBackRow, 2 )  &&	// c1 is not under attack.
-					!m_Opponent.IsAttackingSquare( opponentsAttackingMoves, knBackRow, 3 )  &&	// d1 is not under attack.
-					!m_Opponent.IsAttackingSquare( opponentsAttackingMoves, knBackRow, 4 ) )		// e1 is not under attack (ie. the king is not in check).
-			{
-				// Board index 65 means castle queenside.
-				GeneratedMovesAList[6].push_back( CMove( 65, 65, ePieceType_Null ) );
-			}
-		}
+
+CAutoPtr<CGame> CEngineConfiguration::CreateGame( void ) const throw( CException )
+{
+	CAutoPtr<CGame> pGame;
+
+	try
+	{
+		pGame = new CGame( m_nTranspositionTableSizeInMB );
+	}
+	catch( ... )
+	{
 	}
 
-	// Collate all generated moves into a single vector, sorted by captured piece value.
+	if( pGame == 0 )
+	{
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
 
-	generatedMoves.clear();
+	pGame->SetNumSearchThreads( m_nNumSearchThreads );
 
-	for( i = 0; i < 7; ++i )
+	if( !m_strTablebaseDirectory.empty() )
 	{
-		generatedMoves.insert( generatedMoves.end(), GeneratedMovesAList[i].begin(), GeneratedMovesAList[i].end() );
+		pGame->LoadTablebases( m_strTablebaseDirectory );
 	}
+
+	return( pGame );
 }
 
 
-double CPlayer::FindBestMove( CMove * pBestMove, int nMaxPly,
-	bool bDoAlphaBetaPruning, double dParentMoveValue, double dBestUncleLineValue )
+// **** Class CMatchRunner ****
+
+// Plays a match between two engine configurations, A and B, several games at a
+// time, each game on its own thread with a game for each engine.  Each opening
+// is a few random moves from the initial position, and is played twice, with
+// the colours reversed.  A sequential probability ratio test (SPRT) stops the
+// match as soon as the results show, with the given error rates, that A is
+// stronger than B by Elo1 (H1) or by no more than Elo0 (H0).
+
+static const int cnNumRandomOpeningPlies = 8;
+static const int cnMaxNumMatchGamePlies = 600;		// Longer games are adjudicated drawn.
+static const double cdSPRTAlpha = 0.05;				// The probability of accepting H1 when H0 holds.
+static const double cdSPRTBeta = 0.05;				// The probability of accepting H0 when H1 holds.
+
+class CMatchRunner
 {
-	vector<CMove> generatedMoves;
-	vector<CMove> bestMoves;
+private:
+	CEngineConfiguration m_aConfigurations[2];		// A, then B.
+	int m_nMaxNumGames;
+	int m_nBaseTimeInMilliseconds;
+	int m_nIncrementInMilliseconds;
+	double m_dElo0;
+	double m_dElo1;
+	unsigned long long m_nRandomSeed;
+	mutex m_Mutex;						// Guards the following.
+	int m_nNumGamesStarted;
+	int m_anResults[3];					// A's wins, draws and losses.
+	bool m_bStopMatch;					// The SPRT has made its decision.
+	bool m_bExceptionThrown;
+
+	GameResultType PlayGame( int nGameNumber, string & strReason ) throw( CException );
+	double GetLogLikelihoodRatio( void ) const;
+	double GetEloDifference( void ) const;
+	void RunWorker( void );
 
-	// Generate all moves, including non-attacking moves.
-	GenerateMoves( generatedMoves, false );
+public:
+	CMatchRunner( const CEngineConfiguration & configurationA, const CEngineConfiguration & configurationB,
+		int nMaxNumGames, int nBaseTimeInMilliseconds, int nIncrementInMilliseconds,
+		double dElo0, double dElo1, unsigned long long nRandomSeed );
+
+	void Run( int nNumConcurrentGames ) throw( CException );
+
+}; // class CMatchRunner
+
+
+CMatchRunner::CMatchRunner( const CEngineConfiguration & configurationA, const CEngineConfiguration & configurationB,
+		int nMaxNumGames, int nBaseTimeInMilliseconds, int nIncrementInMilliseconds,
+		double dElo0, double dElo1, unsigned long long nRandomSeed )
+	: m_nMaxNumGames( nMaxNumGames ),
+		m_nBaseTimeInMilliseconds( nBaseTimeInMilliseconds ),
+		m_nIncrementInMilliseconds( nIncrementInMilliseconds ),
+		m_dElo0( dElo0 ),
+		m_dElo1( dElo1 ),
+		m_nRandomSeed( nRandomSeed ),
+		m_nNumGamesStarted( 0 ),
+		m_bStopMatch( false ),
+		m_bExceptionThrown( false )
+{
+	m_aConfigurations[0] = configurationA;
+	m_aConfigurations[1] = configurationB;
+	m_anResults[0] = m_anResults[1] = m_anResults[2] = 0;
+}
 
-	// Try each move in the vector until:
-	// 1) The game ends due to king capture or draw;
-	// 2) Alpha-Beta pruning terminates the search.
-	const int knNumGeneratedMoves = generatedMoves.size();
-	double dBestLineValue = -2000.0;
-	int i = 0;
 
-	for( i = 0; i < knNumGeneratedMoves; ++i )
+GameResultType CMatchRunner::PlayGame( int nGameNumber, string & strReason ) throw( CException )
+{
+	// Play one game; A has White in the even-numbered games.
+	// apGames[0] is the game of the engine playing White.
+	const int knWhiteConfiguration = nGameNumber % 2;
+	CAutoPtr<CGame> apGames[2];
+	int anTimeLeft[2];
+	int anIncrement[2];
+
+	for( int nPlayerID = 0; nPlayerID < 2; ++nPlayerID )
 	{
-		// Make the given move, but be able to undo it.
-		const CMove & currentMove = generatedMoves[i];
-		bool bCastlingMove = false;
-		const bool kbOldCanCastleKingside = m_bCanCastleKingside;
-		const bool kbOldCanCastleQueenside = m_bCanCastleQueenside;
-		const int knOldPawnCapturableViaEnPassant = m_Game.m_nPawnCapturableViaEnPassant;
+		const CEngineConfiguration & kConfiguration = m_aConfigurations[nPlayerID == 0 ? knWhiteConfiguration : 1 - knWhiteConfiguration];
 
-		m_Game.m_nPawnCapturableViaEnPassant = -1;
+		apGames[nPlayerID] = kConfiguration.CreateGame();
+		apGames[nPlayerID]->SetRandomSeed( m_nRandomSeed + 2 * nGameNumber + nPlayerID );
+		anTimeLeft[nPlayerID] = (int)( m_nBaseTimeInMilliseconds * kConfiguration.m_dTimeOdds );
+		anIncrement[nPlayerID] = (int)( m_nIncrementInMilliseconds * kConfiguration.m_dTimeOdds );
+	}
 
-		if( currentMove.m_nSrcSquare == 64  ||
-				currentMove.m_nSrcSquare == 65 )
-		{
-			// A castling move.
-			Assert( currentMove.m_nDstSquare == currentMove.m_nSrcSquare );
-			bCastlingMove = true;
+	// Both games of a pair get the same opening.  White's game acts as the arbiter;
+	// Black's game follows the same moves.
+	CGame & arbiter = *apGames[0];
+	CRandomNumberGenerator openingGenerator( m_nRandomSeed ^ (unsigned long long)( nGameNumber / 2 ) );
+	GameResultType result = eGameResult_Draw;
 
-			const int knRow = 7 * m_knSelfID;
+	for( int i = 0; i < cnNumRandomOpeningPlies  &&  !arbiter.IsGameOver( result, strReason ); ++i )
+	{
+		CMoveList generatedMoves;
 
-			nSrcRow = knRow;
-			nSrcCol = 4;
-			nDstRow = knRow;
-			nSrcRow2 = knRow;
-			nDstRow2 = knRow;
+		arbiter.GetPlayerToMove().GenerateMoves( generatedMoves, eGenMoveType_All );
 
-			if( currentMove.m_nSrcSquare == 64 )
-			{
-				// Castle on the kingside.
-				nDstCol = 6;
-				nSrcCol2 = 7;
-				nDstCol2 = 5;
-			}
-			else
-			{
-				// Castle on the queenside.
-				nDstCol = 2;
-				nSrcCol2 = 0;
-				nDstCol2 = 3;
-			}
+		const CMove kMove = generatedMoves[openingGenerator.GetNextBelow( generatedMoves.Size() )];
+
+		apGames[0]->MakeMove( kMove );
+		apGames[1]->MakeMove( kMove );
+	}
 
-			// No capturing can occur here, so we don't need to track any captured pieces.
-			ppSrcSquare = &m_Game.m_anBoard[nSrcRow * 8 + nSrcCol];	// King.
-			ppDstSquare = &m_Game.m_anBoard[nDstRow * 8 + nDstCol];	// King.
-			ppSrcSquare2 = &m_Game.m_anBoard[nSrcRow2 * 8 + nSrcCol2];	// Rook.
-			ppDstSquare2 = &m_Game.m_anBoard[nDstRow2 * 8 + nDstCol2];	// Rook.
+	while( !arbiter.IsGameOver( result, strReason ) )
+	{
 
-			// First, Assert that everything is in the right place.
-			;
+		if( arbiter.m_nNumUndoRecords >= cnMaxNumMatchGamePlies )
+		{
+			strReason = "adjudication";
+			return( eGameResult_Draw );
+		}
 
-			*ppDstSquare = *ppSrcSquare;
-			*ppSrcSquare = 0;
-			(*ppDstSquare)->m_nRow = nDstRow;
-			(*ppDstSquare)->m_nCol = nDstCol;
+		const int knPlayerID = arbiter.m_nPlayerToMove;
+		CGame & engine = *apGames[knPlayerID];
+		CSearchLimits limits( 0, 0, GetMoveTimeInMilliseconds( anTimeLeft[knPlayerID], anIncrement[knPlayerID], 0 ) );
+		CMove bestMove;
+		const chrono::steady_clock::time_point kStartTime = chrono::steady_clock::now();
 
-			*ppDstSquare2 = *ppSrcSquare2;
-			*ppSrcSquare2 = 0;
-			(*ppDstSquare2)->m_nRow = nDstRow2;
-			(*ppDstSquare2)->m_nCol = nDstCol2;
+		engine.Search( limits, bestMove, false );
+		anTimeLeft[knPlayerID] -= (int)chrono::duration_cast<chrono::milliseconds>( chrono::steady_clock::now() - kStartTime ).count();
 
-			// A player can only castle once.
-			m_bCanCastleKingside = false;
-			m_bCanCastleQueenside = false;
-		}
-		else
+		if( anTimeLeft[knPlayerID] < 0 )
 		{
-			// A non-castling one-piece move.
-			Assert( currentMove.m_nSrcSquare >= 0 );
-			Assert( currentMove.m_nSrcSquare < 64 );
-			Assert( currentMove.m_nDstSquare >= 0 );
-			Assert( currentMove.m_nDstSquare < 64 );
+			strReason = "time forfeit";
+			return( knPlayerID == 0 ? eGameResult_BlackWins : eGameResult_WhiteWins );
+		}
 
-			nSrcRow = currentMove.m_nSrcSquare / 8;
-			nSrcCol = currentMove.m_nSrcSquare % 8;
-			nDstRow = currentMove.m_nDstSquare / 8;
-			nDstCol = currentMove.m_nDstSquare % 8;
+		anTimeLeft[knPlayerID] += anIncrement[knPlayerID];
+		apGames[0]->MakeMove( bestMove );
+		apGames[1]->MakeMove( bestMove );
+	}
 
-			ppSrcSquare = &m_Game.m_aBoard[nSrcRow * 8 + nSrcCol];
-			ppDstSquare = &m_Game.m_aBoard[nDstRow * 8 + nDstCol];
+	return( result );
+}
 
-			pMovingPiece = *ppSrcSquare;
 
-			// First, Assert that everything is in the right place.
-			Assert( pMovingPiece != 0 );
+double CMatchRunner::GetLogLikelihoodRatio( void ) const
+{
+	// The log-likelihood ratio of H1 to H0, by the normal approximation to the
+	// distribution of the mean score per game (the "generalized" SPRT).
+	const double kdNumGames = m_anResults[0] + m_anResults[1] + m_anResults[2];
 
-			// Handle en passant captures, where the captured piece isn't on the dest. square.
-			nCapturedCol = nDstCol;
+	if( kdNumGames == 0.0 )
+	{
+		return( 0.0 );
+	}
 
-			if( pMovingPiece->m_pArchetype->m_PieceType == ePieceType_Pawn  &&
-					nDstCol != nSrcCol  &&		// The pawn is capturing something.
-					*ppDstSquare == 0 )				// The dest. square is vacant.
-			{
-				// En passant capture.
-				nCapturedRow = nSrcRow;
-			}
-			else
-			{
-				nCapturedRow = nDstRow;
-			}
+	const double kdScore = ( m_anResults[0] + 0.5 * m_anResults[1] ) / kdNumGames;
+	const double kdVariance = ( m_anResults[0] * ( 1.0 - kdScore ) * ( 1.0 - kdScore ) +
+		m_anResults[1] * ( 0.5 - kdScore ) * ( 0.5 - kdScore ) +
+		m_anResults[2] * kdScore * kdScore ) / kdNumGames;
+
+	if( kdVariance <= 0.0 )
+	{
+		// Every game has had the same result; there is nothing to go on yet.
+		return( 0.0 );
+	}
 
-			ppCaptureSquare = &m_Game.m_aBoard[nCapturedRow * 8 + nCapturedCol];
-			pCapturedPiece = *ppCaptureSquare;
+	// The expected scores under the two hypotheses, by the logistic Elo model.
+	const double kdScore0 = 1.0 / ( 1.0 + pow( 10.0, -m_dElo0 / 400.0 ) );
+	const double kdScore1 = 1.0 / ( 1.0 + pow( 10.0, -m_dElo1 / 400.0 ) );
 
-			if( pCapturedPiece != 0 )
-			{
-				// Assert that the captured piece is an opposing piece, not your own.
-				;
+	return( kdNumGames * ( kdScore1 - kdScore0 ) * ( 2.0 * kdScore - kdScore0 - kdScore1 ) / ( 2.0 * kdVariance ) );
+}
+
+
+double CMatchRunner::GetEloDifference( void ) const
+{
+	// A's strength relative to B's, estimated from the score so far.
+	const double kdNumGames = m_anResults[0] + m_anResults[1] + m_anResults[2];
+	const double kdScore = kdNumGames > 0.0 ? ( m_anResults[0] + 0.5 * m_anResults[1] ) / kdNumGames : 0.5;
+	const double kdClampedScore = min( max( kdScore, 0.001 ), 0.999 );
+
+	return( -400.0 * log10( 1.0 / kdClampedScore - 1.0 ) );
+}
+
+
+void CMatchRunner::RunWorker( void )
+{
+	// The body of a worker thread: play games until the match is over.
+	const double kdLowerBound = log( cdSPRTBeta / ( 1.0 - cdSPRTAlpha ) );
+	const double kdUpperBound = log( ( 1.0 - cdSPRTBeta ) / cdSPRTAlpha );
 
-				// Mark the captured piece as captured.
-				pCapturedPiece->m_bCaptured = true;
+	for( ;; )
+	{
+		int nGameNumber = 0;
+
+		{
+			lock_guard<mutex> lock( m_Mutex );
+
+			if( m_bStopMatch  ||  m_nNumGamesStarted >= m_nMaxNumGames )
+			{
+				return;
 			}
 
-			// Update the castling flags, if necessary.
-			// If the king moves, both castling flags are set to false.
-			// If a rook moves from its original position, that side's castling flag is set to false.
-			;
+			nGameNumber = m_nNumGamesStarted++;
+		}
+
+		string strReason;
+		GameResultType result = eGameResult_Draw;
 
-			// Set the PawnCapturableViaEnPassant board index, if necessary.
-			;
+		try
+		{
+			result = PlayGame( nGameNumber, strReason );
+		}
+		catch( ... )
+		{
+			lock_guard<mutex> lock( m_Mutex );
 
-			// Update the board to reflect the move.
-			*ppCaptureSquare = 0;
-			*ppDstSquare = *ppSrcSquare;
-			*ppSrcSquare = 0;
-			(*ppDstSquare)->m_nRow = nDstRow;
-			(*ppDstSquare)->m_nCol = nDstCol;
+			m_bExceptionThrown = true;
+			m_bStopMatch = true;
+			return;
 		}
 
-		dLineValue = dCapturedPieceValue;
+		// Score the game from A's point of view.
+		const bool kbAHasWhite = nGameNumber % 2 == 0;
+		const int knResultForA = kbAHasWhite ? (int)result : 2 - (int)result;
+		lock_guard<mutex> lock( m_Mutex );
 
-		// Recurse if we're not too deep, and if the game isn't already over.
+		++m_anResults[knResultForA];
 
-		if( nMaxPly > 0  &&  dCapturedPieceValue < 1000.0 )
+		const double kdLogLikelihoodRatio = GetLogLikelihoodRatio();
+
+		if( kdLogLikelihoodRatio <= kdLowerBound  ||  kdLogLikelihoodRatio >= kdUpperBound )
 		{
-			dLineValue -= FindBestMove( 0, nMaxPly - 1, i > 0, dCapturedPieceValue, dBestLineValue );
+			m_bStopMatch = true;
 		}
 
-		// Undo the given move:
-		// 1) Restore the castling flags.
-		// 2) Restore the pawn-capturable-by-en-passant board index.
-		// 3) Restore the captured piece, if any.
-		// 4) Restore the moved piece(s) to its/their previous position(s).
-		m_bCanCastleKingside = kbOldCanCastleKingside;
-		m_bCanCastleQueenside = kbOldCanCastleQueenside;
-		m_Game.m_nPawnCapturableViaEnPassant = knOldPawnCapturableViaEnPassant;
+		lock_guard<mutex> outputLock( gs_OutputMutex );
+		const char * const kapcResults[] = { "1-0", "1/2-1/2", "0-1" };
 
-		// Record the move, if it's a best move.
-		const bool kbNewBestLine = dLineValue > dBestLineValue;
+		cout << "Game " << nGameNumber + 1 << " (" <<
+			m_aConfigurations[kbAHasWhite ? 0 : 1].m_strName << " vs " << m_aConfigurations[kbAHasWhite ? 1 : 0].m_strName << "): " <<
+			kapcResults[result] << " {" << strReason << "}; A +" << m_anResults[0] << " =" << m_anResults[1] << " -" << m_anResults[2] <<
+			"; Elo " << GetEloDifference() << "; LLR " << kdLogLikelihoodRatio << " (" << kdLowerBound << ", " << kdUpperBound << ")" << endl;
+	}
+}
 
-		if( pBestMove != 0  &&  dLineValue >= dBestLineValue )
-		{
 
-			if( kbNewBestLine )
-			{
-				dBestLineValue = dLineValue;
-				bestMoves.clear();
-			}
+void CMatchRunner::Run( int nNumConcurrentGames ) throw( CException )
+{
+	vector<thread> threads;
+	const chrono::steady_clock::time_point kStartTime = chrono::steady_clock::now();
 
-			bestMoves.push_back( generatedMoves[i] );
-		}
+	if( nNumConcurrentGames < 1  ||  m_nMaxNumGames < 1  ||  m_nBaseTimeInMilliseconds < 1  ||  m_nIncrementInMilliseconds < 0  ||
+		m_dElo1 <= m_dElo0 )
+	{
+		ThrowException( eStatus_InvalidParameter );
+	}
 
-		// Do any pruning.
+	for( int i = 0; i < nNumConcurrentGames; ++i )
+	{
 
-		if( bDoAlphaBetaPruning  &&  kbNewBestLine  &&
-				dParentMoveValue - dBestLineValue < dBestUncleLineValue )
+		try
+		{
+			threads.push_back( thread( &CMatchRunner::RunWorker, this ) );
+		}
+		catch( ... )
 		{
+			// Run with the threads we have.
 			break;
 		}
 	}
 
-	if( pBestMove != 0 )
+	if( threads.empty() )
+	{
+		ThrowException( eStatus_ResourceAcquisitionFailed );
+	}
+
+	for( size_t i = 0; i < threads.size(); ++i )
+	{
+		threads[i].join();
+	}
+
+	if( m_bExceptionThrown )
 	{
-		//Assert( bestMoves.size() > 0 );
-		srand( time( 0 ) );
-		*pBestMove = bestMoves[rand() % bestMoves.size()];
+		ThrowException( eStatus_ResourceAcquisitionFailed );
 	}
 
-	return( dBestLineValue );
+	const double kdSeconds = chrono::duration<double>( chrono::steady_clock::now() - kStartTime ).count();
+	const double kdLogLikelihoodRatio = GetLogLikelihoodRatio();
+
+	cout << "Games: " << m_anResults[0] + m_anResults[1] + m_anResults[2] << " in " << kdSeconds << " seconds; A +" <<
+		m_anResults[0] << " =" << m_anResults[1] << " -" << m_anResults[2] << "; Elo " << GetEloDifference() << endl;
+	cout << "SPRT (Elo0 " << m_dElo0 << ", Elo1 " << m_dElo1 << "): LLR " << kdLogLikelihoodRatio << "; ";
+
+	if( kdLogLikelihoodRatio >= log( ( 1.0 - cdSPRTBeta ) / cdSPRTAlpha ) )
+	{
+		cout << "H1 accepted" << endl;
+	}
+	else if( kdLogLikelihoodRatio <= log( cdSPRTBeta / ( 1.0 - cdSPRTAlpha ) ) )
+	{
+		cout << "H0 accepted" << endl;
+	}
+	else
+	{
+		cout << "inconclusive" << endl;
+	}
 }
 
 
-CGame::CGame( void )
-	: m_KingArchetype( ePieceType_King ),
-		m_QueenArchetype( ePieceType_Queen ),
-		m_RookArchetype( ePieceType_Rook ),
-		m_BishopArchetype( ePieceType_Bishop ),
-		m_KnightArchetype( ePieceType_Knight ),
-		m_PawnArchetype( ePieceType_Pawn ),
-		m_WhitePlayer( 0, *this, m_BlackPlayer ),
-		m_BlackPlayer( 1, *this, m_WhitePlayer ),
-		m_nPawnCapturableViaEnPassant( -1 )
+void CGame::Play( void ) throw( CException )
 {
-	InitializeBoard();
+	// Play under the control of a chess GUI.
+	CUCIDriver driver( *this );
+
+	driver.Run();
 }
 
 
-void CGame::InitializeBoard( void )
+int main( int argc, char * argv[] )
 {
-	int i = 0;
-	int nVectorSize = 0;
-
-	for( i = 0; i < cnBoardArea; ++i )
+	// Usage:
+	// pdchess2							Play a game, under the control of a UCI chess GUI.
+	// pdchess2 perft <depth> [FEN]		Count the leaf nodes of the move tree.
+	// pdchess2 divide <depth> [FEN]	The same, broken down by the first move.
+	// pdchess2 perftsuite [max depth]	Check the move generator and the book keys against reference values.
+	// pdchess2 search depth|nodes|time <limit> [FEN]	Find the best move within the given budget.
+	// pdchess2 smp <threads> <depth> [FEN]	Compare the multithreaded search with the single-threaded one.
+	// pdchess2 tbgen <directory> [max pieces]	Generate the endgame tablebases.
+	// pdchess2 epd <file> depth|nodes|time <limit> [threads]	Run a suite of test positions.
+	// pdchess2 loadfens <file>			Measure the rate at which positions are loaded from a FEN or EPD file.
+	// pdchess2 match <max games> <concurrent games> <ms>[+<increment ms>] [A options] [B options] [Elo0 Elo1]
+	//									Play a self-play match between two configurations; see CEngineConfiguration.
+	// Any of these may be preceded by "seed <n>", which seeds the random number
+	// generator that chooses among equally good moves, so that a run can be repeated,
+	// and by "tablebases <directory>", which makes the search use the tablebases there.
+	unsigned long long nRandomSeed = (unsigned long long)time( 0 );
+	string strTablebaseDirectory;
+
+	while( argc > 2 )
 	{
-		m_anBoard[i] = 0;
+		const string kstrOption = argv[1];
+
+		if( kstrOption == "seed" )
+		{
+			nRandomSeed = strtoull( argv[2], 0, 10 );
+		}
+		else if( kstrOption == "tablebases" )
+		{
+			strTablebaseDirectory = argv[2];
+		}
+		else
+		{
+			break;
+		}
+
+		argc -= 2;
+		argv += 2;
 	}
 
-	nVectorSize = m_WhitePlayer.mPieces.size();
+	const string kstrMode = argc > 1 ? argv[1] : "";
+	int nExitCode = 0;
 
-	for( i = 0; i < nVectorSize; ++i )
-	{
-		CPiece * pPiece = &m_WhitePlayer.mPieces[i];
-		const int knBoardIndex = pPiece->m_nRow * 8 + pPiece->m_nCol;
+	// The banners would confuse a GUI.
+	const bool kbPrintBanners = !kstrMode.empty();
 
-		m_anBoard[knBoardIndex] = pPiece;
+	if( kbPrintBanners )
+	{
+		cout << "pdchess2 : Starting..." << endl;
 	}
 
-	nVectorSize = m_BlackPlayer.mPieces.size();
-
-	for( i = 0; i < nVectorSize; ++i )
+	try
 	{
-		CPiece * pPiece = &m_BlackPlayer.mPieces[i];
-		const int knBoardIndex = pPiece->m_nRow * 8 + pPiece->m_nCol;
+		CAutoPtr<CGame> pGame = new CGame;
 
-		m_anBoard[knBoardIndex] = pPiece;
-	}
-}
+		if( pGame == 0 )
+		{
+			ThrowException( eStatus_ResourceAcquisitionFailed );
+		}
 
+		pGame->SetRandomSeed( nRandomSeed );
 
-void CGame::PrintBoard( void ) const
-{
-	// Display row 7 first, row 0 last.
+		if( !strTablebaseDirectory.empty() )
+		{
+			cout << "Tablebases loaded: " << pGame->LoadTablebases( strTablebaseDirectory ) << endl;
+		}
 
-	for( int nRow = 7; nRow >= 0; --nRow )
-	{
+		if( kstrMode == "perft"  ||  kstrMode == "divide" )
+		{
 
-		for( int nCol = 0; nCol < 8; ++nCol )
+			if( argc < 3 )
+			{
+				ThrowException( eStatus_InvalidParameter );
+			}
+
+			if( argc > 3 )
+			{
+				// The FEN string may have been passed as several arguments.
+				string strFEN = argv[3];
+
+				for( int i = 4; i < argc; ++i )
+				{
+					strFEN = strFEN + " " + argv[i];
+				}
+
+				pGame->LoadFEN( strFEN.c_str() );
+			}
+
+			pGame->RunPerft( atoi( argv[2] ), kstrMode == "divide" );
+		}
+		else if( kstrMode == "search" )
 		{
-			char cOutput = '?';
-			const CPiece * const pPiece = m_anBoard[nRow * 8 + nCol];
+			const string kstrLimitType = argc > 2 ? argv[2] : "";
+			CSearchLimits limits;
+			CMove bestMove;
 
-			if( pPiece == 0 )
+			if( argc < 4 )
 			{
-				cOutput = ( nRow + nCol ) % 2 == 0 ? '*' : ' ';
+				ThrowException( eStatus_InvalidParameter );
+			}
+			else if( kstrLimitType == "depth" )
+			{
+				limits.m_nMaxDepth = atoi( argv[3] );
+			}
+			else if( kstrLimitType == "nodes" )
+			{
+				limits.m_nMaxNodes = strtoull( argv[3], 0, 10 );
+			}
+			else if( kstrLimitType == "time" )
+			{
+				limits.m_nMaxTimeInMilliseconds = atoi( argv[3] );
 			}
 			else
 			{
-				cOutput = pPiece->m_pArchetype->m_Printable;
+				ThrowException( eStatus_InvalidParameter );
+			}
+
+			if( argc > 4 )
+			{
+				string strFEN = argv[4];
 
-				if( pPiece->m_Owner.m_knSelfID == 1 )	// It's a black piece.
+				for( int i = 5; i < argc; ++i )
 				{
-					cOutput += 'a' - 'A';
+					strFEN = strFEN + " " + argv[i];
 				}
+
+				pGame->LoadFEN( strFEN.c_str() );
 			}
 
-			cout << cOutput;
+			pGame->Search( limits, bestMove, true );
+			cout << "bestmove " << ( bestMove == CMove() ? string( "(none)" ) : pGame->MoveToString( bestMove ) ) << endl;
 		}
+		else if( kstrMode == "smp" )
+		{
 
-		cout << '\n';
-	}
-}
+			if( argc < 4 )
+			{
+				ThrowException( eStatus_InvalidParameter );
+			}
 
+			string strFEN;
 
-void CGame::Play( void ) throw( CException )
-{
-}
+			for( int i = 4; i < argc; ++i )
+			{
+				strFEN = strFEN + ( i > 4 ? " " : "" ) + argv[i];
+			}
 
+			CGame::RunSMPBenchmark( atoi( argv[2] ), atoi( argv[3] ), strFEN.empty() ? 0 : strFEN.c_str(), nRandomSeed );
+		}
+		else if( kstrMode == "epd" )
+		{
+			const string kstrLimitType = argc > 3 ? argv[3] : "";
+			CSearchLimits limits;
 
-int main( void )
-{
-	cout << "pdchess2 : Starting..." << endl;
+			if( argc < 5 )
+			{
+				ThrowException( eStatus_InvalidParameter );
+			}
+			else if( kstrLimitType == "depth" )
+			{
+				limits.m_nMaxDepth = atoi( argv[4] );
+			}
+			else if( kstrLimitType == "nodes" )
+			{
+				limits.m_nMaxNodes = strtoull( argv[4], 0, 10 );
+			}
+			else if( kstrLimitType == "time" )
+			{
+				limits.m_nMaxTimeInMilliseconds = atoi( argv[4] );
+			}
+			else
+			{
+				ThrowException( eStatus_InvalidParameter );
+			}
 
-	try
-	{
-		CAutoPtr<CGame> pGame = new CGame;
+			CTestSuiteRunner runner( argv[2], limits, nRandomSeed, strTablebaseDirectory );
 
-		if( pGame == 0 )
+			nExitCode = runner.Run( argc > 5 ? atoi( argv[5] ) : max( 1, (int)thread::hardware_concurrency() ) ) ? 0 : 1;
+		}
+		else if( kstrMode == "loadfens" )
 		{
-			ThrowException( eStatus_ResourceAcquisitionFailed );
+
+			if( argc < 3 )
+			{
+				ThrowException( eStatus_InvalidParameter );
+			}
+
+			CGame::RunFENBenchmark( argv[2] );
+		}
+		else if( kstrMode == "tbgen" )
+		{
+
+			if( argc < 3 )
+			{
+				ThrowException( eStatus_InvalidParameter );
+			}
+
+			nExitCode = CGame::GenerateTablebases( argv[2], argc > 3 ? atoi( argv[3] ) : cnMaxNumTablebasePieces ) ? 0 : 1;
+		}
+		else if( kstrMode == "match" )
+		{
+
+			if( argc < 5 )
+			{
+				ThrowException( eStatus_InvalidParameter );
+			}
+
+			// The time control is the base time in milliseconds, optionally followed by "+" and the increment.
+			const string kstrTimeControl = argv[4];
+			const size_t knPlus = kstrTimeControl.find( '+' );
+			CEngineConfiguration configurationA( "A" );
+			CEngineConfiguration configurationB( "B" );
+
+			configurationA.m_strTablebaseDirectory = configurationB.m_strTablebaseDirectory = strTablebaseDirectory;
+			configurationA.Parse( argc > 5 ? argv[5] : "default" );
+			configurationB.Parse( argc > 6 ? argv[6] : "default" );
+
+			CMatchRunner runner( configurationA, configurationB, atoi( argv[2] ),
+				atoi( kstrTimeControl.c_str() ), knPlus != string::npos ? atoi( kstrTimeControl.c_str() + knPlus + 1 ) : 0,
+				argc > 7 ? atof( argv[7] ) : 0.0, argc > 8 ? atof( argv[8] ) : 10.0, nRandomSeed );
+
+			runner.Run( atoi( argv[3] ) );
 		}
+		else if( kstrMode == "perftsuite" )
+		{
+			const bool kbPerftPassed = CGame::RunPerftSuite( argc > 2 ? atoi( argv[2] ) : 4 );
 
-		pGame->Play();
+			nExitCode = kbPerftPassed  &&  CGame::CheckPolyglotKeys() ? 0 : 1;
+		}
+		else
+		{
+			pGame->Play();
+		}
 	}
 	catch( const CException & e )
 	{
 		cout << "Exception thrown on line " << e.GetLineNumber() << endl;
+		nExitCode = 1;
 	}
 	catch( ... )
 	{
 		// Do nothing.
+		nExitCode = 1;
 	}
 
-	cout << "pdchess2 : Finished." << endl;
-
-	char cDummy;
-
-	cout << "Enter a character: ";
-	cin >> cDummy;
+	if( kbPrintBanners )
+	{
+		cout << "pdchess2 : Finished." << endl;
+	}
 
-	return( 0 );
+	return( nExitCode );
 } // main()
 
 